@@ -1,5 +1,5 @@
 install(
-    TARGETS world_of_blocks_exe
+    TARGETS world_of_blocks_exe world_of_blocks_pregen_exe
     RUNTIME COMPONENT world_of_blocks_Runtime
 )
 
@@ -11,17 +11,29 @@
 // Cube lib
 #include "Block.hpp"
 #include "math.hpp"
+#include "palette_storage.hpp"
 
 // Raylib
 #include "raylib.h"
 
+struct chunk_occupancy;
+
 class Chunk {
 public:
   Chunk() {}
   Chunk(std::vector<Block> _blocks, int _chunk_x, int _chunk_y, int _chunk_z)
+      : blocks(_blocks), chunk_coor_x(_chunk_x), chunk_coor_y(_chunk_y), chunk_coor_z(_chunk_z) {}
+  // Take already packed blocks, no unpacked copy
+  Chunk(palette_storage _blocks, int _chunk_x, int _chunk_y, int _chunk_z)
       : blocks(std::move(_blocks)), chunk_coor_x(_chunk_x), chunk_coor_y(_chunk_y), chunk_coor_z(_chunk_z) {}
+  // Uniform chunk, only the block type is stored until the first edit
+  Chunk(const Block _block, int _chunk_x, int _chunk_y, int _chunk_z)
+      : blocks(chunk_size_x * chunk_size_y * chunk_size_z, _block.block_type), chunk_coor_x(_chunk_x), chunk_coor_y(_chunk_y), chunk_coor_z(_chunk_z) {}
 
-  ~Chunk() { unload_model(); }
+  ~Chunk() {
+    unload_model();
+    unload_mesh();
+  }
 
   void unload_model() noexcept {
     if (model == nullptr) {
@@ -31,13 +43,48 @@ public:
     model = nullptr;
   }
 
-  inline std::vector<Block> &get_blocks() { return blocks; }
+  // Free a CPU mesh never uploaded to the GPU, safe outside of the OpenGL thread
+  void unload_mesh() noexcept {
+    if (mesh == nullptr) {
+      return;
+    }
+    MemFree(mesh->vertices);
+    MemFree(mesh->normals);
+    MemFree(mesh->texcoords);
+    MemFree(mesh->indices);
+    mesh = nullptr;
+  }
+
+  // Unpacked copy of the blocks, in memory order
+  inline std::vector<Block> get_blocks() const { return blocks.to_blocks(); }
+
+  inline Block get_block(const int x, const int y, const int z) const noexcept {
+    return Block(blocks.get(math::convert_to_1d(x, y, z, chunk_size_x, chunk_size_y, chunk_size_z)));
+  }
+
+  inline void set_block(const int x, const int y, const int z, const Block &block) {
+    blocks.set(math::convert_to_1d(x, y, z, chunk_size_x, chunk_size_y, chunk_size_z), block.block_type);
+    saved = false;
+    edited = true;
+  }
+
+  inline void set_blocks(std::vector<Block> &_blocks) {
+    this->blocks = palette_storage(_blocks);
+    saved = false;
+  }
 
-  inline Block &get_block(const int x, const int y, const int z) { return blocks[math::convert_to_1d(x, y, z, chunk_size_x, chunk_size_y, chunk_size_z)]; }
+  inline const palette_storage &get_storage() const noexcept { return blocks; }
 
-  inline void set_blocks(std::vector<Block> &_blocks) { this->blocks = std::move(_blocks); }
+  // All blocks have the same type (all air, all stone...), no block index is stored
+  inline bool is_uniform() const noexcept { return !blocks.empty() && blocks.bits_per_block() == 0; }
 
-  inline std::vector<Block>::size_type size() const noexcept { return blocks.size(); }
+  // Block type of a uniform chunk
+  inline Block get_uniform_block() const noexcept { return Block(blocks.get(0)); }
+
+  inline size_t size() const noexcept { return blocks.size(); }
+
+  // Memory used by the chunk and its block storage (without meshes and models)
+  inline size_t memory_bytes() const noexcept { return sizeof(Chunk) + blocks.memory_bytes(); }
 
   inline benlib::Vector3i chunk_size() const noexcept { return {chunk_size_x, chunk_size_y, chunk_size_z}; }
 
@@ -65,12 +112,30 @@ public:
 
   [[nodiscard]] static inline benlib::Vector3i get_chunk_position(const Vector3 &pos) { return get_chunk_position(pos.x, pos.y, pos.z); }
 
-  void set_model(std::unique_ptr<Model> _model) { model = std::move(_model); }
+  void set_model(std::unique_ptr<Model> _model) {
+    unload_model();
+    model = std::move(_model);
+  }
 
   inline Model *get_model() const { return model.get(); }
 
   inline bool has_model() const { return model != nullptr; }
 
+  // CPU mesh built by a worker thread, waiting to be uploaded on the OpenGL thread
+  void set_mesh(std::unique_ptr<Mesh> _mesh) {
+    unload_mesh();
+    mesh = std::move(_mesh);
+  }
+
+  inline std::unique_ptr<Mesh> take_mesh() noexcept { return std::move(mesh); }
+
+  inline bool has_mesh() const { return mesh != nullptr; }
+
+  // Solid blocks bitmask, shared with mesh jobs of this chunk and its neighbours
+  inline void set_occupancy(std::shared_ptr<const chunk_occupancy> _occupancy) noexcept { occupancy = std::move(_occupancy); }
+
+  inline const std::shared_ptr<const chunk_occupancy> &get_occupancy() const noexcept { return occupancy; }
+
   inline bool is_empty() const { return blocks.empty(); }
 
   inline bool is_full() const { return blocks.size() == chunk_size_x * chunk_size_y * chunk_size_z; }
@@ -105,13 +170,23 @@ public:
   inline bool is_visible_chunk() const noexcept { return isVisible; }
   inline void set_visible_chunk(const bool visible) noexcept { isVisible = visible; }
 
+  // The blocks are the same as on disk (loaded or saved, no edit since), nothing to save on unload
+  inline bool is_saved() const noexcept { return saved; }
+  inline void set_saved(const bool _saved) noexcept { saved = _saved; }
+
+  // A block was set since the chunk was generated, the chunk differs from what the seed gives
+  inline bool is_edited() const noexcept { return edited; }
+  inline void set_edited(const bool _edited) noexcept { edited = _edited; }
+
   static constexpr int chunk_size_x = 32;
   static constexpr int chunk_size_y = 32;
   static constexpr int chunk_size_z = 32;
 
 protected:
-  std::vector<Block> blocks;
+  palette_storage blocks;
   std::unique_ptr<Model> model = nullptr;
+  std::unique_ptr<Mesh> mesh = nullptr;
+  std::shared_ptr<const chunk_occupancy> occupancy = nullptr;
 
   // Chunk coordinates
   int chunk_coor_x = 0;
@@ -120,6 +195,8 @@ protected:
 
   bool isActive = true;
   bool isVisible = true;
+  bool saved = false;
+  bool edited = false;
 };
 
 #endif // WORLD_OF_CUBE_CHUNK_HPP
\ No newline at end of file
@@ -1,7 +1,10 @@
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
+#include <limits>
 #include <numeric>
 #include <random>
 #include <string>
@@ -17,18 +20,54 @@
 
 #include "Generator.hpp"
 
-Generator::Generator(int32_t _seed) : seed(_seed) {
-  fnSimplex = FastNoise::New<FastNoise::Perlin>();
-  fnFractal = FastNoise::New<FastNoise::FractalFBm>();
+namespace {
+// Noise of the last area, reused between chunks. One per thread, generateChunks runs generateChunk on OpenMP threads
+thread_local std::vector<float> noise_buffer;
+// Terrain buffer and cave noises of the chunk being generated
+thread_local terrain_buffer terrain_scratch;
+thread_local std::vector<float> cave_noise_a;
+thread_local std::vector<float> cave_noise_b;
+
+// Stable hash of a world column, for decoration placement
+inline uint64_t column_hash(const int32_t x, const int32_t z, const int32_t seed) noexcept {
+  uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(z)) ^ (static_cast<uint64_t>(static_cast<uint32_t>(seed)) << 17);
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  return h ^ (h >> 31);
+}
 
-  fnFractal->SetSource(fnSimplex);
-  fnFractal->SetOctaveCount(octaves);
-  fnFractal->SetGain(gain);
-  fnFractal->SetLacunarity(lacunarity);
-  fnFractal->SetWeightedStrength(weighted_strength);
+// Structures only grow into air, and trunks win over leaves, so the result does not depend on the placement order
+inline bool place_decoration(block_type::block_t &current, const block_type::block_t type) noexcept {
+  if (current == block_type::air || (current == block_type::leaves && type == block_type::wood)) {
+    current = type;
+    return true;
+  }
+  return false;
+}
+
+// Largest divisor of size not above step (at least 1)
+inline uint32_t lattice_step_divisor(const uint32_t step, const uint32_t size) noexcept {
+  uint32_t divisor = std::clamp(step, 1u, size);
+  while (size % divisor != 0) {
+    divisor--;
+  }
+  return divisor;
 }
+} // namespace
 
-Generator::Generator() {
+Generator::Generator(int32_t _seed) : seed(_seed) { build_noise_tree(); }
+
+Generator::Generator() { build_noise_tree(); }
+
+Generator::Generator(const Generator &other)
+    : seed(other.seed), octaves(other.octaves), lacunarity(other.lacunarity), gain(other.gain), frequency(other.frequency),
+      weighted_strength(other.weighted_strength), multiplier(other.multiplier), noise_lattice_xz(other.noise_lattice_xz), noise_lattice_y(other.noise_lattice_y),
+      classifier_samples(other.classifier_samples), sea_level(other.sea_level), caves(other.caves), decoration(other.decoration),
+      tree_rarity(other.tree_rarity), column_cache(other.column_cache), pending_decorations(other.pending_decorations) {
+  build_noise_tree();
+}
+
+void Generator::build_noise_tree() {
   fnSimplex = FastNoise::New<FastNoise::Perlin>();
   fnFractal = FastNoise::New<FastNoise::FractalFBm>();
 
@@ -39,6 +78,22 @@ Generator::Generator() {
   fnFractal->SetWeightedStrength(weighted_strength);
 }
 
+void Generator::copy_settings(const Generator &other) {
+  reseed(other.seed);
+  setOctaves(other.octaves);
+  set_lacunarity(other.lacunarity);
+  set_gain(other.gain);
+  setFrequency(other.frequency);
+  set_weighted_strength(other.weighted_strength);
+  setMultiplier(other.multiplier);
+  set_noise_lattice(other.noise_lattice_xz, other.noise_lattice_y);
+  set_classifier_samples(other.classifier_samples);
+  set_sea_level(other.sea_level);
+  set_caves(other.caves);
+  set_decoration(other.decoration);
+  set_tree_rarity(other.tree_rarity);
+}
+
 Generator::~Generator() {}
 
 void Generator::reseed(int32_t _seed) { this->seed = _seed; }
@@ -86,6 +141,121 @@ void Generator::set_weighted_strength(float _weighted_strength) {
 
 float Generator::getWeightedStrength() const { return weighted_strength; }
 
+bool Generator::set_noise_lattice(uint32_t _step_xz, uint32_t _step_y) {
+  static_assert(Chunk::chunk_size_x == Chunk::chunk_size_z, "the x/z lattice step divides both chunk sizes");
+  this->noise_lattice_xz = lattice_step_divisor(_step_xz, Chunk::chunk_size_x);
+  this->noise_lattice_y = lattice_step_divisor(_step_y, Chunk::chunk_size_y);
+  return noise_lattice_xz == _step_xz && noise_lattice_y == _step_y;
+}
+
+uint32_t Generator::get_noise_lattice_xz() const { return noise_lattice_xz; }
+
+uint32_t Generator::get_noise_lattice_y() const { return noise_lattice_y; }
+
+void Generator::set_classifier_samples(uint32_t _samples) { this->classifier_samples = _samples; }
+
+uint32_t Generator::get_classifier_samples() const { return classifier_samples; }
+
+chunk_class Generator::classify3d(const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x, const uint32_t size_y,
+                                  const uint32_t size_z) {
+  // Weighted octaves change the amplitudes with the noise itself, the bound below does not hold
+  if (classifier_samples == 0 || weighted_strength != 0.0f || octaves <= 0) {
+    return chunk_class::mixed;
+  }
+
+  // FBm gradient bound per block: octave i has a weight gain^i / sum(gain^j) and a frequency frequency * lacunarity^i
+  float amplitude_sum = 0.0f;
+  float amplitude = 1.0f;
+  for (int32_t i = 0; i < octaves; i++) {
+    amplitude_sum += amplitude;
+    amplitude *= gain;
+  }
+  float gradient_bound = 0.0f;
+  amplitude = 1.0f;
+  float octave_frequency = std::abs(frequency);
+  for (int32_t i = 0; i < octaves; i++) {
+    gradient_bound += amplitude / amplitude_sum * octave_frequency;
+    amplitude *= gain;
+    octave_frequency *= std::abs(lacunarity);
+  }
+  gradient_bound *= perlin_gradient_bound;
+
+  // One sample at the center of each cell of the closed area [begin, begin + size] (coarse lattice points are on its far faces)
+  const uint32_t samples = classifier_samples;
+  const float cell_x = static_cast<float>(size_x) / static_cast<float>(samples);
+  const float cell_y = static_cast<float>(size_y) / static_cast<float>(samples);
+  const float cell_z = static_cast<float>(size_z) / static_cast<float>(samples);
+  const float cell_radius = 0.5f * std::sqrt(cell_x * cell_x + cell_y * cell_y + cell_z * cell_z);
+
+  const size_t sample_count = static_cast<size_t>(samples) * samples * samples;
+  std::vector<float> positions_x(sample_count);
+  std::vector<float> positions_y(sample_count);
+  std::vector<float> positions_z(sample_count);
+  size_t index = 0;
+  for (uint32_t z = 0; z < samples; z++) {
+    for (uint32_t y = 0; y < samples; y++) {
+      for (uint32_t x = 0; x < samples; x++) {
+        positions_x[index] = (static_cast<float>(begin_x) + (static_cast<float>(x) + 0.5f) * cell_x) * frequency;
+        positions_y[index] = (static_cast<float>(begin_y) + (static_cast<float>(y) + 0.5f) * cell_y) * frequency;
+        positions_z[index] = (static_cast<float>(begin_z) + (static_cast<float>(z) + 0.5f) * cell_z) * frequency;
+        index++;
+      }
+    }
+  }
+
+  std::vector<float> noise_samples(sample_count);
+  fnFractal->GenPositionArray3D(noise_samples.data(), static_cast<int>(sample_count), positions_x.data(), positions_y.data(), positions_z.data(), 0.0f, 0.0f,
+                                0.0f, seed);
+  const auto minmax = std::minmax_element(noise_samples.begin(), noise_samples.end());
+
+  // Noise range of the whole area, with a margin for float rounding
+  const float margin = gradient_bound * cell_radius + 1e-4f;
+  const double noise_min = static_cast<double>(*minmax.first - margin);
+  const double noise_max = static_cast<double>(*minmax.second + margin);
+
+  // Same conversion as generate3dHeightmap: a block is stone if uint32((noise + 1) * multiplier) > stone_threshold
+  if ((noise_min + 1.0) * multiplier >= static_cast<double>(stone_threshold + 1)) {
+    return chunk_class::solid;
+  }
+  if ((noise_max + 1.0) * multiplier < static_cast<double>(stone_threshold + 1)) {
+    return chunk_class::air;
+  }
+  return chunk_class::mixed;
+}
+
+void Generator::set_column_cache_capacity(size_t capacity) { column_cache->set_capacity(capacity); }
+
+heightmap_cache &Generator::get_column_cache() noexcept { return *column_cache; }
+
+uint64_t Generator::noise_settings_key() const noexcept {
+  const auto bits = [](const float value) {
+    uint32_t result;
+    std::memcpy(&result, &value, sizeof(result));
+    return static_cast<uint64_t>(result);
+  };
+  uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(octaves));
+  for (const uint64_t value : {bits(lacunarity), bits(gain), bits(frequency), bits(weighted_strength), static_cast<uint64_t>(multiplier)}) {
+    key = (key ^ value) * 0x100000001B3ULL;
+  }
+  return key;
+}
+
+void Generator::set_sea_level(int32_t _sea_level) { this->sea_level = _sea_level; }
+
+int32_t Generator::get_sea_level() const { return sea_level; }
+
+void Generator::set_caves(bool _caves) { this->caves = _caves; }
+
+bool Generator::get_caves() const { return caves; }
+
+void Generator::set_decoration(bool _decoration) { this->decoration = _decoration; }
+
+bool Generator::get_decoration() const { return decoration; }
+
+void Generator::set_tree_rarity(uint32_t _tree_rarity) { this->tree_rarity = _tree_rarity; }
+
+uint32_t Generator::get_tree_rarity() const { return tree_rarity; }
+
 void Generator::setMultiplier(uint32_t _multiplier) { this->multiplier = _multiplier; }
 
 uint32_t Generator::get_multiplier() const { return multiplier; }
@@ -135,7 +305,7 @@ std::vector<uint32_t> Generator::generate3dHeightmap(const int32_t begin_x, cons
     return heightmap;
   }
 
-  fnFractal->GenUniformGrid3D(noise_output.data(), begin_x, begin_y, begin_z, size_x, size_y, size_z, frequency, seed);
+  generate3d_noise(noise_output.data(), begin_x, begin_y, begin_z, size_x, size_y, size_z);
 
   // Convert noise_output to heightmap
   for (uint32_t i = 0; i < size_x * size_y * size_z; i++) {
@@ -155,6 +325,472 @@ std::vector<uint32_t> Generator::generate3dHeightmap(const int32_t begin_x, cons
   return heightmap;
 }
 
+void Generator::generate3d_noise(float *noise_output, const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x,
+                                 const uint32_t size_y, const uint32_t size_z) {
+  if (!generate3d_noise_lattice(noise_output, begin_x, begin_y, begin_z, size_x, size_y, size_z)) {
+    fnFractal->GenUniformGrid3D(noise_output, begin_x, begin_y, begin_z, size_x, size_y, size_z, frequency, seed);
+  }
+}
+
+float Generator::stone_noise_threshold(const uint32_t _multiplier) noexcept {
+  // Exact float bound of the double precision test, so thresholding floats gives the same blocks
+  const double limit = static_cast<double>(stone_threshold + 1);
+  const auto is_stone = [&](const float noise) { return (static_cast<double>(noise) + 1.0) * _multiplier >= limit; };
+
+  float threshold = static_cast<float>(limit / _multiplier - 1.0);
+  while (is_stone(threshold)) {
+    threshold = std::nextafter(threshold, -std::numeric_limits<float>::infinity());
+  }
+  while (!is_stone(threshold) && threshold != std::numeric_limits<float>::infinity()) {
+    threshold = std::nextafter(threshold, std::numeric_limits<float>::infinity());
+  }
+  return threshold;
+}
+
+void Generator::threshold_blocks(const float *noise, block_type::block_t *blocks, const size_t count, const float noise_threshold) noexcept {
+#pragma omp simd
+  for (size_t i = 0; i < count; i++) {
+    blocks[i] = noise[i] >= noise_threshold ? block_type::stone : block_type::air;
+  }
+}
+
+bool Generator::generate3d_noise_lattice(float *noise_output, const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x,
+                                         const uint32_t size_y, const uint32_t size_z) {
+  const uint32_t step_xz = noise_lattice_xz;
+  const uint32_t step_y = noise_lattice_y;
+  if ((step_xz == 1 && step_y == 1) || size_x % step_xz != 0 || size_z % step_xz != 0 || size_y % step_y != 0) {
+    return false;
+  }
+
+  // Lattice points on both area borders
+  const uint32_t lattice_x = size_x / step_xz + 1;
+  const uint32_t lattice_y = size_y / step_y + 1;
+  const uint32_t lattice_z = size_z / step_xz + 1;
+  const size_t lattice_count = static_cast<size_t>(lattice_x) * lattice_y * lattice_z;
+
+  // Same sample positions as GenUniformGrid3D on the lattice points
+  std::vector<float> positions_x(lattice_count);
+  std::vector<float> positions_y(lattice_count);
+  std::vector<float> positions_z(lattice_count);
+  size_t index = 0;
+  for (uint32_t z = 0; z < lattice_z; z++) {
+    for (uint32_t y = 0; y < lattice_y; y++) {
+      for (uint32_t x = 0; x < lattice_x; x++) {
+        positions_x[index] = static_cast<float>(begin_x + static_cast<int32_t>(x * step_xz)) * frequency;
+        positions_y[index] = static_cast<float>(begin_y + static_cast<int32_t>(y * step_y)) * frequency;
+        positions_z[index] = static_cast<float>(begin_z + static_cast<int32_t>(z * step_xz)) * frequency;
+        index++;
+      }
+    }
+  }
+
+  std::vector<float> lattice(lattice_count);
+  fnFractal->GenPositionArray3D(lattice.data(), static_cast<int>(lattice_count), positions_x.data(), positions_y.data(), positions_z.data(), 0.0f, 0.0f, 0.0f,
+                                seed);
+
+  const auto lattice_at = [&](const uint32_t x, const uint32_t y, const uint32_t z) { return lattice[(z * lattice_y + y) * lattice_x + x]; };
+
+  // Trilinear interpolation, in memory order (x fastest)
+  for (uint32_t z = 0; z < size_z; z++) {
+    const uint32_t z0 = z / step_xz;
+    const float fz = static_cast<float>(z % step_xz) / static_cast<float>(step_xz);
+    for (uint32_t y = 0; y < size_y; y++) {
+      const uint32_t y0 = y / step_y;
+      const float fy = static_cast<float>(y % step_y) / static_cast<float>(step_y);
+      float *out = noise_output + math::convert_to_1d(0u, y, z, size_x, size_y, size_z);
+
+      for (uint32_t x0 = 0; x0 + 1 < lattice_x; x0++) {
+        // Interpolate on y and z at both x ends of the cell, then along x
+        const float c00 = lattice_at(x0, y0, z0) + (lattice_at(x0, y0 + 1, z0) - lattice_at(x0, y0, z0)) * fy;
+        const float c01 = lattice_at(x0, y0, z0 + 1) + (lattice_at(x0, y0 + 1, z0 + 1) - lattice_at(x0, y0, z0 + 1)) * fy;
+        const float c10 = lattice_at(x0 + 1, y0, z0) + (lattice_at(x0 + 1, y0 + 1, z0) - lattice_at(x0 + 1, y0, z0)) * fy;
+        const float c11 = lattice_at(x0 + 1, y0, z0 + 1) + (lattice_at(x0 + 1, y0 + 1, z0 + 1) - lattice_at(x0 + 1, y0, z0 + 1)) * fy;
+        const float start = c00 + (c01 - c00) * fz;
+        const float end = c10 + (c11 - c10) * fz;
+
+        for (uint32_t i = 0; i < step_xz; i++) {
+          *out++ = start + (end - start) * (static_cast<float>(i) / static_cast<float>(step_xz));
+        }
+      }
+    }
+  }
+  return true;
+}
+
+uint32_t Generator::get_terrain_apron_y() const noexcept {
+  const uint32_t step = std::max(noise_lattice_y, 1u);
+  return (surface_depth + step - 1) / step * step;
+}
+
+void Generator::prepare_terrain_buffer(terrain_buffer &buffer, const int32_t chunk_x, const int32_t chunk_y, const int32_t chunk_z) const {
+  buffer.begin_x = chunk_x * Chunk::chunk_size_x;
+  buffer.begin_y = chunk_y * Chunk::chunk_size_y;
+  buffer.begin_z = chunk_z * Chunk::chunk_size_z;
+  buffer.size_y = Chunk::chunk_size_y + get_terrain_apron_y();
+  buffer.blocks.resize(static_cast<size_t>(Chunk::chunk_size_x) * buffer.size_y * Chunk::chunk_size_z);
+}
+
+void Generator::terrain_density(terrain_buffer &buffer) {
+  noise_buffer.resize(buffer.blocks.size());
+  generate3d_noise(noise_buffer.data(), buffer.begin_x, buffer.begin_y, buffer.begin_z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z);
+  threshold_blocks(noise_buffer.data(), buffer.blocks.data(), buffer.blocks.size(), stone_noise_threshold(multiplier));
+}
+
+void Generator::terrain_surface(terrain_buffer &buffer) const noexcept {
+  // Per column: stone blocks since the last air going down (the ground above the buffer counts as deep), and if the top is near the sea
+  std::array<uint32_t, Chunk::chunk_size_x> depth;
+  std::array<bool, Chunk::chunk_size_x> sandy;
+
+  for (uint32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    depth.fill(surface_depth);
+    sandy.fill(false);
+    for (uint32_t y = buffer.size_y; y-- > 0;) {
+      const bool in_chunk = y < Chunk::chunk_size_y;
+      const bool near_sea = buffer.begin_y + static_cast<int32_t>(y) <= sea_level + 1;
+      block_type::block_t *row = buffer.blocks.data() + math::convert_to_1d<size_t>(0, y, z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z);
+
+      for (uint32_t x = 0; x < Chunk::chunk_size_x; x++) {
+        if (row[x] == block_type::air || row[x] == block_type::water) {
+          depth[x] = 0;
+          continue;
+        }
+        if (depth[x] == 0) {
+          sandy[x] = near_sea;
+        }
+        if (depth[x] < surface_depth && in_chunk) {
+          row[x] = sandy[x] ? block_type::sand : (depth[x] == 0 ? block_type::grass : block_type::dirt);
+        }
+        depth[x] = std::min(depth[x] + 1, surface_depth);
+      }
+    }
+  }
+}
+
+void Generator::terrain_water(terrain_buffer &buffer) const noexcept {
+  // Only the chunk rows below the sea level
+  const auto rows = static_cast<uint32_t>(std::clamp<int64_t>(static_cast<int64_t>(sea_level) - buffer.begin_y, 0, Chunk::chunk_size_y));
+  for (uint32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    block_type::block_t *slab = buffer.blocks.data() + math::convert_to_1d<size_t>(0, 0, z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z);
+#pragma omp simd
+    for (size_t i = 0; i < static_cast<size_t>(rows) * Chunk::chunk_size_x; i++) {
+      slab[i] = slab[i] == block_type::air ? block_type::water : slab[i];
+    }
+  }
+}
+
+void Generator::terrain_caves(terrain_buffer &buffer) {
+  if (!caves) {
+    return;
+  }
+
+  // Tunnels where two independent noises are both close to 0, chunk rows only
+  const size_t count = static_cast<size_t>(Chunk::chunk_size_x) * Chunk::chunk_size_y * Chunk::chunk_size_z;
+  cave_noise_a.resize(count);
+  cave_noise_b.resize(count);
+  fnSimplex->GenUniformGrid3D(cave_noise_a.data(), buffer.begin_x, buffer.begin_y, buffer.begin_z, Chunk::chunk_size_x, Chunk::chunk_size_y,
+                              Chunk::chunk_size_z, cave_frequency, seed + 1);
+  fnSimplex->GenUniformGrid3D(cave_noise_b.data(), buffer.begin_x, buffer.begin_y, buffer.begin_z, Chunk::chunk_size_x, Chunk::chunk_size_y,
+                              Chunk::chunk_size_z, cave_frequency, seed + 2);
+
+  constexpr float radius_squared = cave_radius * cave_radius;
+  for (uint32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    block_type::block_t *slab = buffer.blocks.data() + math::convert_to_1d<size_t>(0, 0, z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z);
+    const size_t noise_offset = math::convert_to_1d<size_t>(0, 0, z, Chunk::chunk_size_x, Chunk::chunk_size_y, Chunk::chunk_size_z);
+    const float *noise_a = cave_noise_a.data() + noise_offset;
+    const float *noise_b = cave_noise_b.data() + noise_offset;
+#pragma omp simd
+    for (size_t i = 0; i < static_cast<size_t>(Chunk::chunk_size_x) * Chunk::chunk_size_y; i++) {
+      const bool carved = noise_a[i] * noise_a[i] + noise_b[i] * noise_b[i] < radius_squared && slab[i] != block_type::water;
+      slab[i] = carved ? block_type::air : slab[i];
+    }
+  }
+}
+
+template <typename Place>
+void Generator::place_tree(const int32_t x, const int32_t ground, const int32_t z, const uint64_t hash, Place &&place) const noexcept {
+  const int32_t top = ground + static_cast<int32_t>(tree_min_height + (hash >> 32) % 3);
+  for (int32_t y = top - 1; y <= top + 1; y++) {
+    const int32_t radius = y > top ? tree_leaves_radius - 1 : tree_leaves_radius;
+    for (int32_t dz = -radius; dz <= radius; dz++) {
+      for (int32_t dx = -radius; dx <= radius; dx++) {
+        if (std::abs(dx) + std::abs(dz) < 2 * radius) {
+          place(x + dx, y, z + dz, block_type::leaves);
+        }
+      }
+    }
+  }
+  for (int32_t y = ground + 1; y < top; y++) {
+    place(x, y, z, block_type::wood);
+  }
+}
+
+namespace {
+// Block of a structure at chunk coordinates (x, y, z) outside of the chunk, sent to the overflow of the neighbour chunk
+inline void add_overflow(std::vector<std::pair<benlib::Vector3i, pending_block>> &overflow, const benlib::Vector3i &chunk_pos, const int32_t x,
+                         const int32_t y, const int32_t z, const block_type::block_t type) {
+  const int32_t offset_x = x < 0 ? -1 : (x >= Chunk::chunk_size_x ? 1 : 0);
+  const int32_t offset_y = y < 0 ? -1 : (y >= Chunk::chunk_size_y ? 1 : 0);
+  const int32_t offset_z = z < 0 ? -1 : (z >= Chunk::chunk_size_z ? 1 : 0);
+  const auto index = math::convert_to_1d<size_t>(x - offset_x * Chunk::chunk_size_x, y - offset_y * Chunk::chunk_size_y, z - offset_z * Chunk::chunk_size_z,
+                                                 Chunk::chunk_size_x, Chunk::chunk_size_y, Chunk::chunk_size_z);
+  overflow.push_back({{chunk_pos.x + offset_x, chunk_pos.y + offset_y, chunk_pos.z + offset_z}, {static_cast<uint16_t>(index), type}});
+}
+
+inline bool in_chunk(const int32_t x, const int32_t y, const int32_t z) noexcept {
+  return x >= 0 && x < Chunk::chunk_size_x && y >= 0 && y < Chunk::chunk_size_y && z >= 0 && z < Chunk::chunk_size_z;
+}
+} // namespace
+
+void Generator::terrain_decoration(terrain_buffer &buffer) const noexcept {
+  buffer.overflow.clear();
+  if (!decoration || tree_rarity == 0) {
+    return;
+  }
+
+  const benlib::Vector3i chunk_pos = {buffer.begin_x / Chunk::chunk_size_x, buffer.begin_y / Chunk::chunk_size_y, buffer.begin_z / Chunk::chunk_size_z};
+  const auto at = [&](const int32_t x, const int32_t y, const int32_t z) -> block_type::block_t & {
+    return buffer.blocks[math::convert_to_1d<size_t>(x, y, z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z)];
+  };
+  // Blocks outside of the chunk (apron included) go to the overflow of the neighbour chunk
+  const auto place = [&](const int32_t x, const int32_t y, const int32_t z, const block_type::block_t type) {
+    if (in_chunk(x, y, z)) {
+      place_decoration(at(x, y, z), type);
+      return;
+    }
+    add_overflow(buffer.overflow, chunk_pos, x, y, z, type);
+  };
+
+  // Each chunk seeds the trees of its own columns, on the highest grass block of the column
+  for (int32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    for (int32_t x = 0; x < Chunk::chunk_size_x; x++) {
+      const uint64_t hash = column_hash(buffer.begin_x + x, buffer.begin_z + z, seed);
+      if (hash % tree_rarity != 0) {
+        continue;
+      }
+
+      int32_t ground = Chunk::chunk_size_y - 1;
+      while (ground >= 0 && (at(x, ground, z) == block_type::air || at(x, ground, z) == block_type::leaves)) {
+        ground--;
+      }
+      if (ground < 0 || at(x, ground, z) != block_type::grass) {
+        continue;
+      }
+      place_tree(x, ground, z, hash, place);
+    }
+  }
+}
+
+void Generator::republish_decorations(const Chunk &chunk) {
+  if (!decoration || tree_rarity == 0) {
+    return;
+  }
+  // No grass, no tree
+  if (chunk.is_uniform() && chunk.get_uniform_block().block_type != block_type::grass) {
+    return;
+  }
+
+  const benlib::Vector3i chunk_pos = chunk.get_position();
+  std::vector<std::pair<benlib::Vector3i, pending_block>> overflow;
+  const auto place = [&](const int32_t x, const int32_t y, const int32_t z, const block_type::block_t type) {
+    if (!in_chunk(x, y, z)) {
+      add_overflow(overflow, chunk_pos, x, y, z, type);
+    }
+  };
+
+  for (int32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    for (int32_t x = 0; x < Chunk::chunk_size_x; x++) {
+      const uint64_t hash = column_hash(chunk_pos.x * Chunk::chunk_size_x + x, chunk_pos.z * Chunk::chunk_size_z + z, seed);
+      if (hash % tree_rarity != 0) {
+        continue;
+      }
+
+      // Same ground as terrain_decoration: the trunk of the column's own tree (and wood from below) was not there yet
+      int32_t ground = Chunk::chunk_size_y - 1;
+      block_type::block_t type = block_type::air;
+      for (; ground >= 0; ground--) {
+        type = chunk.get_block(x, ground, z).block_type;
+        if (type != block_type::air && type != block_type::leaves && type != block_type::wood) {
+          break;
+        }
+      }
+      if (ground < 0 || type != block_type::grass) {
+        continue;
+      }
+      place_tree(x, ground, z, hash, place);
+    }
+  }
+  publish_decorations(chunk_pos, overflow);
+}
+
+void Generator::publish_decorations(const terrain_buffer &buffer) {
+  const benlib::Vector3i source = {buffer.begin_x / Chunk::chunk_size_x, buffer.begin_y / Chunk::chunk_size_y, buffer.begin_z / Chunk::chunk_size_z};
+  publish_decorations(source, buffer.overflow);
+}
+
+void Generator::publish_decorations(const benlib::Vector3i &source, const std::vector<std::pair<benlib::Vector3i, pending_block>> &overflow) {
+  if (overflow.empty()) {
+    return;
+  }
+
+  // One entry per target chunk (at most the 17 neighbours above and around)
+  std::vector<std::pair<benlib::Vector3i, std::vector<pending_block>>> targets;
+  for (const auto &[target, block] : overflow) {
+    auto it = std::find_if(targets.begin(), targets.end(), [&](const auto &entry) {
+      return entry.first.x == target.x && entry.first.y == target.y && entry.first.z == target.z;
+    });
+    if (it == targets.end()) {
+      targets.push_back({target, {}});
+      it = std::prev(targets.end());
+    }
+    it->second.push_back(block);
+  }
+  for (auto &[target, blocks] : targets) {
+    pending_decorations->set(target, source, std::move(blocks));
+  }
+}
+
+bool Generator::apply_pending_decorations(Chunk &chunk) const {
+  const std::vector<pending_block> blocks = pending_decorations->get(chunk.get_position());
+  // Structure blocks are generated terrain, not edits
+  const bool edited = chunk.is_edited();
+  bool changed = false;
+  for (const auto &block : blocks) {
+    const int x = block.index % Chunk::chunk_size_x;
+    const int y = (block.index / Chunk::chunk_size_x) % Chunk::chunk_size_y;
+    const int z = block.index / (Chunk::chunk_size_x * Chunk::chunk_size_y);
+    block_type::block_t current = chunk.get_block(x, y, z).block_type;
+    if (place_decoration(current, block.block_type)) {
+      chunk.set_block(x, y, z, Block(current));
+      changed = true;
+    }
+  }
+  chunk.set_edited(edited);
+  return changed;
+}
+
+decoration_store &Generator::get_decoration_store() noexcept { return *pending_decorations; }
+
+void Generator::run_terrain_stages(terrain_buffer &buffer, const terrain_stage first_stage) {
+  for (size_t stage = static_cast<size_t>(first_stage); stage < terrain_stage_count; stage++) {
+    const auto start = std::chrono::steady_clock::now();
+    switch (static_cast<terrain_stage>(stage)) {
+    case terrain_stage::density:
+      terrain_density(buffer);
+      break;
+    case terrain_stage::surface:
+      terrain_surface(buffer);
+      break;
+    case terrain_stage::water:
+      terrain_water(buffer);
+      break;
+    case terrain_stage::caves:
+      terrain_caves(buffer);
+      break;
+    case terrain_stage::decoration:
+      terrain_decoration(buffer);
+      break;
+    }
+    add_stage_time(static_cast<terrain_stage>(stage), start);
+  }
+  const auto start = std::chrono::steady_clock::now();
+  publish_decorations(buffer);
+  add_stage_time(terrain_stage::decoration, start);
+  staged_chunks++;
+}
+
+std::unique_ptr<Chunk> Generator::chunk_from_terrain(const terrain_buffer &buffer, const int32_t chunk_x, const int32_t chunk_y, const int32_t chunk_z) {
+  static_assert(sizeof(Block) == sizeof(block_type::block_t), "Blocks are written as block_t");
+  thread_local std::vector<Block> blocks;
+  blocks.resize(static_cast<size_t>(Chunk::chunk_size_x) * Chunk::chunk_size_y * Chunk::chunk_size_z);
+
+  // Drop the apron rows, one copy per z slab
+  constexpr size_t slab_size = static_cast<size_t>(Chunk::chunk_size_x) * Chunk::chunk_size_y;
+  for (uint32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    std::memcpy(reinterpret_cast<block_type::block_t *>(blocks.data()) + z * slab_size,
+                buffer.blocks.data() + math::convert_to_1d<size_t>(0, 0, z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z), slab_size);
+  }
+  return std::make_unique<Chunk>(palette_storage(blocks), chunk_x, chunk_y, chunk_z);
+}
+
+std::unique_ptr<Chunk> Generator::classified_terrain_chunk(const chunk_class _class, terrain_buffer &buffer, const int32_t chunk_x, const int32_t chunk_y,
+                                                          const int32_t chunk_z) {
+  const auto start = std::chrono::steady_clock::now();
+  staged_chunks++;
+
+  // All air: only the water stage can change it
+  if (_class == chunk_class::air) {
+    if (buffer.begin_y >= sea_level || buffer.begin_y + Chunk::chunk_size_y <= sea_level) {
+      const block_type::block_t fill = buffer.begin_y >= sea_level ? block_type::air : block_type::water;
+      add_stage_time(terrain_stage::water, start);
+      return std::make_unique<Chunk>(Block(fill), chunk_x, chunk_y, chunk_z);
+    }
+    std::fill(buffer.blocks.begin(), buffer.blocks.end(), block_type::air);
+    terrain_water(buffer);
+    add_stage_time(terrain_stage::water, start);
+    return chunk_from_terrain(buffer, chunk_x, chunk_y, chunk_z);
+  }
+
+  // All stone (apron included): no surface, no water, no grass for trees, only caves
+  if (!caves) {
+    return std::make_unique<Chunk>(Block(block_type::stone), chunk_x, chunk_y, chunk_z);
+  }
+  std::fill(buffer.blocks.begin(), buffer.blocks.end(), block_type::stone);
+  terrain_caves(buffer);
+  add_stage_time(terrain_stage::caves, start);
+  return chunk_from_terrain(buffer, chunk_x, chunk_y, chunk_z);
+}
+
+void Generator::add_stage_time(const terrain_stage stage, const std::chrono::steady_clock::time_point start) noexcept {
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  stage_nanoseconds[static_cast<size_t>(stage)] += static_cast<uint64_t>(elapsed.count());
+}
+
+terrain_stage_times Generator::get_stage_times() const noexcept {
+  terrain_stage_times times;
+  for (size_t stage = 0; stage < terrain_stage_count; stage++) {
+    times.nanoseconds[stage] = stage_nanoseconds[stage];
+  }
+  times.chunks = staged_chunks;
+  return times;
+}
+
+void Generator::reset_stage_times() noexcept {
+  for (auto &nanoseconds : stage_nanoseconds) {
+    nanoseconds = 0;
+  }
+  staged_chunks = 0;
+}
+
+const char *Generator::get_stage_name(const terrain_stage stage) noexcept {
+  switch (stage) {
+  case terrain_stage::density:
+    return "density";
+  case terrain_stage::surface:
+    return "surface";
+  case terrain_stage::water:
+    return "water";
+  case terrain_stage::caves:
+    return "caves";
+  case terrain_stage::decoration:
+    return "decoration";
+  }
+  return "unknown";
+}
+
+std::unique_ptr<Chunk> Generator::generate_baseline_chunk(const int32_t chunk_x, const int32_t chunk_y, const int32_t chunk_z) {
+  terrain_buffer &buffer = terrain_scratch;
+  prepare_terrain_buffer(buffer, chunk_x, chunk_y, chunk_z);
+
+  // Chunks far from the surface are uniform (apron included), skip the noise grid
+  const chunk_class _class =
+      classify3d(chunk_x * Chunk::chunk_size_x, chunk_y * Chunk::chunk_size_y, chunk_z * Chunk::chunk_size_z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z);
+  if (_class != chunk_class::mixed) {
+    return classified_terrain_chunk(_class, buffer, chunk_x, chunk_y, chunk_z);
+  }
+  run_terrain_stages(buffer, terrain_stage::density);
+  return chunk_from_terrain(buffer, chunk_x, chunk_y, chunk_z);
+}
+
 std::unique_ptr<Chunk> Generator::generateChunk(const int32_t chunk_x, const int32_t chunk_y, const int32_t chunk_z, const bool generate_3d_terrain) {
   const int32_t real_x = chunk_x * Chunk::chunk_size_x;
   const int32_t real_y = chunk_y * Chunk::chunk_size_y;
@@ -162,14 +798,19 @@ std::unique_ptr<Chunk> Generator::generateChunk(const int32_t chunk_x, const int
 
   std::vector<Block> blocks;
 
-  std::unique_ptr<Chunk> _chunk = std::make_unique<Chunk>();
-
   if (generate_3d_terrain) {
-    blocks = std::move(generate3d(real_x, real_y, real_z, Chunk::chunk_size_x, Chunk::chunk_size_y, Chunk::chunk_size_z));
-  } else {
-    blocks = std::move(generate2d(real_x, real_y, real_z, Chunk::chunk_size_x, Chunk::chunk_size_y, Chunk::chunk_size_z));
+    std::unique_ptr<Chunk> _chunk = generate_baseline_chunk(chunk_x, chunk_y, chunk_z);
+    // Structures of the already generated neighbours
+    if (decoration) {
+      apply_pending_decorations(*_chunk);
+    }
+    return _chunk;
   }
 
+  std::unique_ptr<Chunk> _chunk = std::make_unique<Chunk>();
+
+  blocks = std::move(generate2d(real_x, real_y, real_z, Chunk::chunk_size_x, Chunk::chunk_size_y, Chunk::chunk_size_z));
+
   _chunk->set_blocks(blocks);
   _chunk->set_chuck_pos(chunk_x, chunk_y, chunk_z);
 
@@ -179,95 +820,166 @@ std::unique_ptr<Chunk> Generator::generateChunk(const int32_t chunk_x, const int
 [[nodiscard]] std::vector<std::unique_ptr<Chunk>> Generator::generateChunks(const int32_t begin_chunk_x, const int32_t begin_chunk_y,
                                                                              const int32_t begin_chunk_z, const uint32_t size_x, const uint32_t size_y,
                                                                              const uint32_t size_z, const bool generate_3d_terrain) {
-  constexpr bool debug = false;
+  const auto chunk_count = static_cast<int64_t>(size_x) * size_y * size_z;
+  std::vector<std::unique_ptr<Chunk>> chunks(static_cast<size_t>(chunk_count));
+
+  // Each iteration writes its own slot, the order does not depend on the thread count or on the schedule
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t i = 0; i < chunk_count; i++) {
+    const auto x = static_cast<int32_t>(i % size_x);
+    const auto y = static_cast<int32_t>((i / size_x) % size_y);
+    const auto z = static_cast<int32_t>(i / (static_cast<int64_t>(size_x) * size_y));
+    chunks[static_cast<size_t>(i)] = generateChunk(begin_chunk_x + x, begin_chunk_y + y, begin_chunk_z + z, generate_3d_terrain);
+  }
 
-  std::vector<std::unique_ptr<Chunk>> chunks;
-  chunks.reserve(size_x * size_y * size_z);
-  /*
-  if (chunks.size() < size_x * size_y * size_z) {
-      spdlog::error("Chunks size is not equal or bigger than size_x * size_y * size_z!");
-      exit(1);
-  }
-  */
-
-#pragma omp parallel for collapse(3) schedule(auto)
-  for (int32_t x = begin_chunk_x; x < begin_chunk_x + size_x; x++) {
-    for (int32_t z = begin_chunk_y; z < begin_chunk_y + size_z; z++) {
-      for (int32_t y = begin_chunk_z; y < begin_chunk_z + size_y; y++) {
-        auto gen_chunk = generateChunk(x, y, z, generate_3d_terrain);
-#pragma omp critical
-        chunks.emplace_back(std::move(gen_chunk));
-      }
+  // Structures of chunks generated later in the batch, so the result does not depend on the generation order
+  if (generate_3d_terrain && decoration) {
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t i = 0; i < chunk_count; i++) {
+      apply_pending_decorations(*chunks[static_cast<size_t>(i)]);
     }
   }
 
   return chunks;
 }
 
-std::vector<Block> Generator::generate2d(const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x, const uint32_t size_y,
-                                          const uint32_t size_z) {
-  constexpr bool debug = false;
-
-  std::vector<uint32_t> heightmap;
-  std::vector<Block> blocks = std::vector<Block>(size_x * size_y * size_z, Block());
+std::vector<std::unique_ptr<Chunk>> Generator::generate_region(const int32_t begin_chunk_x, const int32_t begin_chunk_y, const int32_t begin_chunk_z,
+                                                                const uint32_t size_x, const uint32_t size_y, const uint32_t size_z,
+                                                                const bool generate_3d_terrain) {
+  const size_t chunk_count = static_cast<size_t>(size_x) * size_y * size_z;
+  std::vector<std::unique_ptr<Chunk>> chunks(chunk_count);
 
-  heightmap = std::move(generate2dMeightmap(begin_x, begin_y, begin_z, size_x, size_y, size_z));
-
-  // Generate blocks
-  for (uint32_t x = 0; x < size_x; x++) {
+  // 2D terrain already shares its noise through the column cache
+  if (!generate_3d_terrain) {
+    size_t i = 0;
     for (uint32_t z = 0; z < size_z; z++) {
-      // Noise value is divided by 4 to make it smaller and it is used as the height of the Block (z)
-      std::vector<Block>::size_type vec_index = math::convert_to_1d(x, z, size_x, size_z);
-
-      uint32_t noise_value = heightmap[vec_index] / 4;
-
       for (uint32_t y = 0; y < size_y; y++) {
-        // Calculate real y from begin_y
-        vec_index = math::convert_to_1d(x, y, z, size_x, size_y, size_z);
+        for (uint32_t x = 0; x < size_x; x++) {
+          chunks[i++] = generateChunk(begin_chunk_x + static_cast<int32_t>(x), begin_chunk_y + static_cast<int32_t>(y), begin_chunk_z + static_cast<int32_t>(z), false);
+        }
+      }
+    }
+    return chunks;
+  }
 
-        if constexpr (debug) {
-          std::cout << "x: " << x << ", z: " << z << ", y: " << y << " index: " << vec_index << ", noise: " << static_cast<int32_t>(noise_value) << std::endl;
+  // Classify each chunk first (apron included), the noise grid only covers the bounding box of the mixed chunks and its apron
+  const uint32_t apron_y = get_terrain_apron_y();
+  std::vector<chunk_class> classes(chunk_count);
+  uint32_t min_x = size_x, min_y = size_y, min_z = size_z;
+  uint32_t max_x = 0, max_y = 0, max_z = 0;
+  size_t i = 0;
+  for (uint32_t z = 0; z < size_z; z++) {
+    for (uint32_t y = 0; y < size_y; y++) {
+      for (uint32_t x = 0; x < size_x; x++, i++) {
+        classes[i] = classify3d((begin_chunk_x + static_cast<int32_t>(x)) * Chunk::chunk_size_x, (begin_chunk_y + static_cast<int32_t>(y)) * Chunk::chunk_size_y,
+                                (begin_chunk_z + static_cast<int32_t>(z)) * Chunk::chunk_size_z, Chunk::chunk_size_x, Chunk::chunk_size_y + apron_y,
+                                Chunk::chunk_size_z);
+        if (classes[i] == chunk_class::mixed) {
+          min_x = std::min(min_x, x), min_y = std::min(min_y, y), min_z = std::min(min_z, z);
+          max_x = std::max(max_x, x), max_y = std::max(max_y, y), max_z = std::max(max_z, z);
         }
+      }
+    }
+  }
 
-        Block &current_block = blocks[vec_index];
+  uint32_t region_x = 0, region_y = 0, region_z = 0;
+  if (min_x < size_x) {
+    const auto start = std::chrono::steady_clock::now();
+    region_x = (max_x - min_x + 1) * Chunk::chunk_size_x;
+    region_y = (max_y - min_y + 1) * Chunk::chunk_size_y + apron_y;
+    region_z = (max_z - min_z + 1) * Chunk::chunk_size_z;
+    noise_buffer.resize(static_cast<size_t>(region_x) * region_y * region_z);
+    generate3d_noise(noise_buffer.data(), (begin_chunk_x + static_cast<int32_t>(min_x)) * Chunk::chunk_size_x,
+                     (begin_chunk_y + static_cast<int32_t>(min_y)) * Chunk::chunk_size_y, (begin_chunk_z + static_cast<int32_t>(min_z)) * Chunk::chunk_size_z,
+                     region_x, region_y, region_z);
+    add_stage_time(terrain_stage::density, start);
+  }
 
-        // If the noise value is greater than the current Block, make it air
-        if (noise_value > 120) {
-          current_block.block_type = block_type::stone;
+  const float noise_threshold = stone_noise_threshold(multiplier);
+  terrain_buffer &buffer = terrain_scratch;
+
+  i = 0;
+  for (uint32_t z = 0; z < size_z; z++) {
+    for (uint32_t y = 0; y < size_y; y++) {
+      for (uint32_t x = 0; x < size_x; x++, i++) {
+        const int32_t chunk_x = begin_chunk_x + static_cast<int32_t>(x);
+        const int32_t chunk_y = begin_chunk_y + static_cast<int32_t>(y);
+        const int32_t chunk_z = begin_chunk_z + static_cast<int32_t>(z);
+        prepare_terrain_buffer(buffer, chunk_x, chunk_y, chunk_z);
+        if (classes[i] != chunk_class::mixed) {
+          chunks[i] = classified_terrain_chunk(classes[i], buffer, chunk_x, chunk_y, chunk_z);
           continue;
         }
+
+        // Density stage: threshold the chunk rows (apron included) straight from the region noise
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t block_z = 0; block_z < Chunk::chunk_size_z; block_z++) {
+          for (uint32_t block_y = 0; block_y < buffer.size_y; block_y++) {
+            const size_t region_index = math::convert_to_1d<size_t>((x - min_x) * Chunk::chunk_size_x, (y - min_y) * Chunk::chunk_size_y + block_y,
+                                                                    (z - min_z) * Chunk::chunk_size_z + block_z, region_x, region_y, region_z);
+            const size_t buffer_index = math::convert_to_1d<size_t>(0, block_y, block_z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z);
+            threshold_blocks(noise_buffer.data() + region_index, buffer.blocks.data() + buffer_index, Chunk::chunk_size_x, noise_threshold);
+          }
+        }
+        add_stage_time(terrain_stage::density, start);
+        run_terrain_stages(buffer, terrain_stage::surface);
+        chunks[i] = chunk_from_terrain(buffer, chunk_x, chunk_y, chunk_z);
       }
     }
   }
-  return blocks;
+
+  // Structures of the neighbours, once all chunks of the region are seeded
+  if (decoration) {
+    for (auto &chunk : chunks) {
+      apply_pending_decorations(*chunk);
+    }
+  }
+  return chunks;
 }
 
-std::vector<Block> Generator::generate3d(const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x, const uint32_t size_y,
+std::vector<Block> Generator::generate2d(const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x, const uint32_t size_y,
                                           const uint32_t size_z) {
-  constexpr bool debug = false;
-
   std::vector<Block> blocks = std::vector<Block>(size_x * size_y * size_z, Block());
 
-  std::vector<uint32_t> heightmap = generate3dHeightmap(begin_x, begin_y, begin_z, size_x, size_y, size_z);
-
-  // Generate blocks
-  for (uint32_t x = 0; x < size_x; x++) {
-    for (uint32_t z = 0; z < size_z; z++) {
-      for (uint32_t y = 0; y < size_y; y++) {
-        size_t vec_index = math::convert_to_1d(x, y, z, size_x, size_y, size_z);
-        const uint32_t noise_value = heightmap[vec_index];
-        auto &current_block = blocks[vec_index];
+  // The chunks of a column share the same 2D noise, only chunk sized columns are cached
+  heightmap_cache::heightmap_t heightmap;
+  const bool cacheable = size_x == Chunk::chunk_size_x && size_z == Chunk::chunk_size_z && column_cache->get_capacity() > 0;
+  const heightmap_cache::key_t key = {begin_x, begin_z, static_cast<uint32_t>(seed), noise_settings_key()};
+  if (cacheable) {
+    heightmap = column_cache->get(key);
+  }
+  if (heightmap == nullptr) {
+    heightmap = std::make_shared<const std::vector<uint32_t>>(generate2dMeightmap(begin_x, begin_y, begin_z, size_x, size_y, size_z));
+    if (cacheable) {
+      column_cache->put(key, heightmap);
+    }
+  }
 
-        if constexpr (debug) {
-          std::cout << "x: " << x << ", z: " << z << ", y: " << y << " index: " << vec_index << ", noise: " << static_cast<int32_t>(noise_value) << std::endl;
-        }
+  // Fill each column up to its height, in world y so stacked chunks are continuous
+  for (uint32_t z = 0; z < size_z; z++) {
+    for (uint32_t x = 0; x < size_x; x++) {
+      // Noise value is divided by 4 to make it smaller and it is used as the height of the Block (y)
+      const int64_t height = static_cast<int64_t>((*heightmap)[math::convert_to_1d(x, z, size_x, size_z)] / 4);
+      const int64_t fill = std::clamp<int64_t>(height - begin_y, 0, size_y);
 
-        if (noise_value > 120) {
-          current_block.block_type = block_type::stone;
-          continue;
-        }
+      for (uint32_t y = 0; y < static_cast<uint32_t>(fill); y++) {
+        blocks[math::convert_to_1d(x, y, z, size_x, size_y, size_z)].block_type = block_type::stone;
       }
     }
   }
   return blocks;
 }
+
+std::vector<Block> Generator::generate3d(const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x, const uint32_t size_y,
+                                          const uint32_t size_z) {
+  static_assert(sizeof(Block) == sizeof(block_type::block_t), "Blocks are written as block_t");
+  const size_t count = static_cast<size_t>(size_x) * size_y * size_z;
+
+  std::vector<Block> blocks(count);
+  noise_buffer.resize(count);
+
+  generate3d_noise(noise_buffer.data(), begin_x, begin_y, begin_z, size_x, size_y, size_z);
+  // Noise and blocks share the memory order, threshold in one pass
+  threshold_blocks(noise_buffer.data(), reinterpret_cast<block_type::block_t *>(blocks.data()), count, stone_noise_threshold(multiplier));
+  return blocks;
+}
@@ -2,6 +2,8 @@
 #define WORLD_OF_CUBE_GENERATOR_HPP
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <iostream>
@@ -27,16 +29,72 @@
 // Cube lib
 #include "Block.hpp"
 #include "Chunk.hpp"
+#include "decoration_store.hpp"
+#include "heightmap_cache.hpp"
 #include "math.hpp"
 
+// Result of the noise bounds classification of an area
+enum class chunk_class : uint8_t {
+  // Straddles the surface, needs full generation
+  mixed = 0,
+  // Proven all air
+  air = 1,
+  // Proven all stone
+  solid = 2,
+};
+
+// Stages of the 3D terrain pipeline, in execution order
+enum class terrain_stage : uint8_t {
+  // Noise threshold to stone or air
+  density = 0,
+  // Grass (sand near the sea level) on top of the stone, dirt below
+  surface = 1,
+  // Air below the sea level becomes water
+  water = 2,
+  // Tunnels carved in the ground
+  caves = 3,
+  // Trees on grass
+  decoration = 4,
+};
+
+inline constexpr size_t terrain_stage_count = 5;
+
+// Time spent in each terrain stage since the last reset
+struct terrain_stage_times {
+  std::array<uint64_t, terrain_stage_count> nanoseconds = {};
+  // Chunks that went through the pipeline
+  uint64_t chunks = 0;
+};
+
+// Blocks of a chunk going through the terrain stages, in memory order (x fastest, then y, then z).
+// The rows above the chunk (apron) let the surface stage see the ground above the chunk top, only the chunk rows are kept
+struct terrain_buffer {
+  int32_t begin_x = 0;
+  int32_t begin_y = 0;
+  int32_t begin_z = 0;
+  // Chunk rows + apron rows
+  uint32_t size_y = 0;
+  std::vector<block_type::block_t> blocks;
+  // Blocks of the chunk structures falling in other chunks (absolute chunk position), filled by the decoration stage
+  std::vector<std::pair<benlib::Vector3i, pending_block>> overflow;
+};
+
 class Generator {
 public:
   explicit Generator(int32_t _seed);
 
   explicit Generator();
 
+  // Copy settings and build a new noise node tree, so the copy can be used on another thread
+  Generator(const Generator &other);
+
+  Generator &operator=(const Generator &other) = delete;
+
   ~Generator();
 
+  // Copy seed and noise settings from another generator (keeps its own noise node tree)
+  void copy_settings(const Generator &other);
+
   void reseed(int32_t _seed);
 
   int32_t randomizeSeed();
@@ -62,6 +120,43 @@ public:
   float getWeightedStrength() const;
 
 
+  // Sample the 3D noise every step_xz blocks on x/z and every step_y blocks on y, trilinear interpolation in between (1: every block).
+  // A step is lowered to the nearest divisor of the chunk size, so chunks and regions always use the same lattice.
+  // Return false if a step was changed
+  bool set_noise_lattice(uint32_t _step_xz, uint32_t _step_y);
+
+  uint32_t get_noise_lattice_xz() const;
+
+  uint32_t get_noise_lattice_y() const;
+
+  // Noise samples per axis of the chunk classifier (0: disabled, always full generation)
+  void set_classifier_samples(uint32_t _samples);
+
+  uint32_t get_classifier_samples() const;
+
+  // Conservative classification of the 3D terrain of an area from a few noise samples and the FBm gradient bound,
+  // air or solid only if every block of the area is proven to be air or stone
+  chunk_class classify3d(const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x, const uint32_t size_y,
+                         const uint32_t size_z);
+
+  // World y of the water surface, air below it becomes water
+  void set_sea_level(int32_t _sea_level);
+
+  int32_t get_sea_level() const;
+
+  void set_caves(bool _caves);
+
+  bool get_caves() const;
+
+  void set_decoration(bool _decoration);
+
+  bool get_decoration() const;
+
+  // One tree every tree_rarity grass columns on average
+  void set_tree_rarity(uint32_t _tree_rarity);
+
+  uint32_t get_tree_rarity() const;
+
   void setMultiplier(uint32_t _multiplier);
 
   uint32_t get_multiplier() const;
@@ -72,12 +167,76 @@ public:
   std::vector<uint32_t> generate3dHeightmap(const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x, const uint32_t size_y,
                                               const uint32_t size_z);
 
+  // 3D noise of the area in memory order (x fastest), on the coarse lattice if enabled
+  void generate3d_noise(float *noise_output, const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x,
+                        const uint32_t size_y, const uint32_t size_z);
+
+  // Smallest noise value giving a stone block, i.e. uint32((noise + 1) * multiplier) > stone_threshold
+  [[nodiscard]] static float stone_noise_threshold(uint32_t _multiplier) noexcept;
+
+  // Noise to block kernel: stone if noise >= noise_threshold, air otherwise, in memory order
+  static void threshold_blocks(const float *noise, block_type::block_t *blocks, size_t count, float noise_threshold) noexcept;
+
+  // Rows above the chunk in a terrain buffer, a multiple of the noise lattice step so the lattice still fits
+  [[nodiscard]] uint32_t get_terrain_apron_y() const noexcept;
+
+  // Size the buffer for the chunk, blocks are not initialized
+  void prepare_terrain_buffer(terrain_buffer &buffer, const int32_t chunk_x, const int32_t chunk_y, const int32_t chunk_z) const;
+
+  // Terrain stages, each one is a pass over the block buffer
+  void terrain_density(terrain_buffer &buffer);
+
+  void terrain_surface(terrain_buffer &buffer) const noexcept;
+
+  void terrain_water(terrain_buffer &buffer) const noexcept;
+
+  void terrain_caves(terrain_buffer &buffer);
+
+  void terrain_decoration(terrain_buffer &buffer) const noexcept;
+
+  // Send the overflow blocks of the buffer's structures to the pending decoration store
+  void publish_decorations(const terrain_buffer &buffer);
+
+  // Publish again the overflow blocks of the trees of a chunk loaded from disk (its own tree blocks are already in it),
+  // the trees are found from the chunk blocks as terrain_decoration finds them
+  void republish_decorations(const Chunk &chunk);
+
+  // Place the pending decoration blocks of the chunk (only into air, wood over leaves), return true if a block changed
+  bool apply_pending_decorations(Chunk &chunk) const;
+
+  // Structure blocks waiting for their chunk, shared with the copies of this generator
+  [[nodiscard]] decoration_store &get_decoration_store() noexcept;
+
+  // Chunk from the chunk rows of a terrain buffer
+  [[nodiscard]] static std::unique_ptr<Chunk> chunk_from_terrain(const terrain_buffer &buffer, const int32_t chunk_x, const int32_t chunk_y,
+                                                                 const int32_t chunk_z);
+
+  [[nodiscard]] terrain_stage_times get_stage_times() const noexcept;
+
+  void reset_stage_times() noexcept;
+
+  [[nodiscard]] static const char *get_stage_name(terrain_stage stage) noexcept;
+
   std::unique_ptr<Chunk> generateChunk(const int32_t chunk_x, const int32_t chunk_y, const int32_t chunk_z, const bool generate_3d_terrain);
 
+  // 3D chunk from the seed alone: its own structures, without the pending blocks of its neighbours (its structures are still published)
+  [[nodiscard]] std::unique_ptr<Chunk> generate_baseline_chunk(const int32_t chunk_x, const int32_t chunk_y, const int32_t chunk_z);
+
   [[nodiscard]] std::vector<std::unique_ptr<Chunk>> generateChunks(const int32_t begin_chunk_x, const int32_t begin_chunk_y, const int32_t begin_chunk_z,
                                                                     const uint32_t size_x, const uint32_t size_y, const uint32_t size_z,
                                                                     const bool generate_3d_terrain);
 
+  // Generate a contiguous block of size_x * size_y * size_z chunks, the 3D noise of all non uniform chunks comes from one grid call
+  // and is thresholded in place into each chunk. Chunks are in memory order (x fastest, then y, then z)
+  [[nodiscard]] std::vector<std::unique_ptr<Chunk>> generate_region(const int32_t begin_chunk_x, const int32_t begin_chunk_y, const int32_t begin_chunk_z,
+                                                                     const uint32_t size_x, const uint32_t size_y, const uint32_t size_z,
+                                                                     const bool generate_3d_terrain);
+
+  // 2D heightmap cache, shared with the copies of this generator (0: disabled)
+  void set_column_cache_capacity(size_t capacity);
+
+  [[nodiscard]] heightmap_cache &get_column_cache() noexcept;
+
   std::vector<Block> generate2d(const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x, const uint32_t size_y,
                                  const uint32_t size_z);
 
@@ -85,6 +244,29 @@ public:
                                  const uint32_t size_z);
 
 private:
+  void build_noise_tree();
+
+  // 3D noise of the area on the coarse lattice, trilinear interpolation for each block, return false if the lattice does not fit the area
+  bool generate3d_noise_lattice(float *noise_output, const int32_t begin_x, const int32_t begin_y, const int32_t begin_z, const uint32_t size_x,
+                                const uint32_t size_y, const uint32_t size_z);
+
+  void publish_decorations(const benlib::Vector3i &source, const std::vector<std::pair<benlib::Vector3i, pending_block>> &overflow);
+
+  // Call place(x, y, z, block type) for each block of the tree seeded on the ground block (x, ground, z), chunk coordinates
+  template <typename Place> void place_tree(int32_t x, int32_t ground, int32_t z, uint64_t hash, Place &&place) const noexcept;
+
+  // Run the terrain stages from first_stage to the end on the buffer, timed
+  void run_terrain_stages(terrain_buffer &buffer, terrain_stage first_stage);
+
+  // Terrain of a chunk classified air or solid, without the density noise
+  [[nodiscard]] std::unique_ptr<Chunk> classified_terrain_chunk(chunk_class _class, terrain_buffer &buffer, const int32_t chunk_x, const int32_t chunk_y,
+                                                                const int32_t chunk_z);
+
+  void add_stage_time(terrain_stage stage, std::chrono::steady_clock::time_point start) noexcept;
+
+  // Key of the 2D noise settings for the column cache
+  [[nodiscard]] uint64_t noise_settings_key() const noexcept;
+
   // default seed
   int32_t seed = 404;
   FastNoise::SmartNode<FastNoise::Perlin> fnSimplex;
@@ -96,6 +278,31 @@ private:
   float frequency = 0.4f;
   float weighted_strength = 0.0f;
   uint32_t multiplier = 128;
+  uint32_t noise_lattice_xz = 1;
+  uint32_t noise_lattice_y = 1;
+  uint32_t classifier_samples = 4;
+  int32_t sea_level = 0;
+  bool caves = true;
+  bool decoration = true;
+  uint32_t tree_rarity = 61;
+
+  std::array<std::atomic<uint64_t>, terrain_stage_count> stage_nanoseconds = {};
+  std::atomic<uint64_t> staged_chunks = 0;
+
+  std::shared_ptr<heightmap_cache> column_cache = std::make_shared<heightmap_cache>();
+  std::shared_ptr<decoration_store> pending_decorations = std::make_shared<decoration_store>();
+
+  // Blocks with a noise value above this are stone
+  static constexpr uint32_t stone_threshold = 120;
+  // Upper bound of the gradient norm of the Perlin source noise (per unit of noise space), with margin
+  static constexpr float perlin_gradient_bound = 4.0f;
+  // Dirt (or sand) layers below the surface block
+  static constexpr uint32_t surface_depth = 3;
+  // Cave tunnels: blocks where both cave noises are close to 0
+  static constexpr float cave_frequency = 0.045f;
+  static constexpr float cave_radius = 0.11f;
+  static constexpr uint32_t tree_min_height = 4;
+  static constexpr int32_t tree_leaves_radius = 2;
 };
 
 #endif // WORLD_OF_CUBE_GENERATOR_HPP
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "GeneratorPool.hpp"
+
+GeneratorPool::GeneratorPool(const Generator &settings, uint32_t thread_count)
+    : pool(thread_count == 0 ? std::max(1u, std::thread::hardware_concurrency()) : thread_count) {
+  const auto worker_count = static_cast<uint32_t>(pool.get_thread_count());
+  generators.reserve(worker_count);
+  for (uint32_t i = 0; i < worker_count; i++) {
+    generators.push_back(std::make_unique<Generator>(settings));
+  }
+}
+
+GeneratorPool::~GeneratorPool() { pool.wait(); }
+
+void GeneratorPool::copy_settings(const Generator &settings) {
+  for (auto &generator : generators) {
+    generator->copy_settings(settings);
+  }
+}
+
+std::vector<std::unique_ptr<Chunk>> GeneratorPool::generateChunks(const std::vector<benlib::Vector3i> &positions, const bool generate_3d_terrain) {
+  std::vector<std::unique_ptr<Chunk>> chunks(positions.size());
+  if (positions.empty()) {
+    return chunks;
+  }
+
+  // One task per worker, each task pulls the next position until all chunks are done (dynamic load balancing)
+  std::atomic<size_t> next_index = 0;
+  const size_t task_count = std::min(generators.size(), positions.size());
+
+  std::vector<std::future<void>> tasks;
+  tasks.reserve(task_count);
+  for (size_t worker = 0; worker < task_count; worker++) {
+    tasks.push_back(pool.submit_task([&, worker]() {
+      Generator &generator = *generators[worker];
+      for (size_t i = next_index++; i < positions.size(); i = next_index++) {
+        chunks[i] = generator.generateChunk(positions[i].x, positions[i].y, positions[i].z, generate_3d_terrain);
+      }
+    }));
+  }
+
+  for (auto &task : tasks) {
+    task.get();
+  }
+
+  apply_pending_decorations(chunks, generate_3d_terrain);
+  return chunks;
+}
+
+std::vector<std::unique_ptr<Chunk>> GeneratorPool::generate_region(const benlib::Vector3i &begin, const benlib::Vector3i &size,
+                                                                    const bool generate_3d_terrain, uint32_t tile_size) {
+  const auto size_x = static_cast<uint32_t>(std::max(size.x, 0));
+  const auto size_y = static_cast<uint32_t>(std::max(size.y, 0));
+  const auto size_z = static_cast<uint32_t>(std::max(size.z, 0));
+  std::vector<std::unique_ptr<Chunk>> chunks(static_cast<size_t>(size_x) * size_y * size_z);
+  if (chunks.empty()) {
+    return chunks;
+  }
+
+  tile_size = std::max(tile_size, 1u);
+  const uint32_t tiles_x = (size_x + tile_size - 1) / tile_size;
+  const uint32_t tiles_y = (size_y + tile_size - 1) / tile_size;
+  const uint32_t tiles_z = (size_z + tile_size - 1) / tile_size;
+
+  // Each tile writes its chunks to their own slots of the region, no lock needed
+  parallel_for_worker(static_cast<size_t>(tiles_x) * tiles_y * tiles_z, [&](Generator &generator, const size_t tile) {
+    const uint32_t tile_x = static_cast<uint32_t>(tile % tiles_x) * tile_size;
+    const uint32_t tile_y = static_cast<uint32_t>((tile / tiles_x) % tiles_y) * tile_size;
+    const uint32_t tile_z = static_cast<uint32_t>(tile / (static_cast<size_t>(tiles_x) * tiles_y)) * tile_size;
+    const uint32_t tile_size_x = std::min(tile_size, size_x - tile_x);
+    const uint32_t tile_size_y = std::min(tile_size, size_y - tile_y);
+    const uint32_t tile_size_z = std::min(tile_size, size_z - tile_z);
+
+    auto tile_chunks = generator.generate_region(begin.x + static_cast<int32_t>(tile_x), begin.y + static_cast<int32_t>(tile_y),
+                                                 begin.z + static_cast<int32_t>(tile_z), tile_size_x, tile_size_y, tile_size_z, generate_3d_terrain);
+    size_t i = 0;
+    for (uint32_t z = 0; z < tile_size_z; z++) {
+      for (uint32_t y = 0; y < tile_size_y; y++) {
+        for (uint32_t x = 0; x < tile_size_x; x++) {
+          chunks[math::convert_to_1d<size_t>(tile_x + x, tile_y + y, tile_z + z, size_x, size_y, size_z)] = std::move(tile_chunks[i++]);
+        }
+      }
+    }
+  });
+
+  apply_pending_decorations(chunks, generate_3d_terrain);
+  return chunks;
+}
+
+void GeneratorPool::apply_pending_decorations(std::vector<std::unique_ptr<Chunk>> &chunks, const bool generate_3d_terrain) {
+  if (!generate_3d_terrain || generators.empty() || !generators.front()->get_decoration()) {
+    return;
+  }
+  // Structures that crossed into chunks generated earlier by another worker
+  parallel_for_worker(chunks.size(), [&](Generator &generator, const size_t i) { generator.apply_pending_decorations(*chunks[i]); });
+}
+
+void GeneratorPool::parallel_for_worker(const size_t count, const std::function<void(Generator &, size_t)> &fn) {
+  std::atomic<size_t> next_index = 0;
+  const size_t task_count = std::min(generators.size(), count);
+
+  std::vector<std::future<void>> tasks;
+  tasks.reserve(task_count);
+  for (size_t worker = 0; worker < task_count; worker++) {
+    tasks.push_back(pool.submit_task([&, worker]() {
+      Generator &generator = *generators[worker];
+      for (size_t i = next_index++; i < count; i = next_index++) {
+        fn(generator, i);
+      }
+    }));
+  }
+
+  for (auto &task : tasks) {
+    task.get();
+  }
+}
+
+void GeneratorPool::parallel_for(const size_t count, const std::function<void(size_t)> &fn) {
+  std::atomic<size_t> next_index = 0;
+  const size_t task_count = std::min(generators.size(), count);
+
+  std::vector<std::future<void>> tasks;
+  tasks.reserve(task_count);
+  for (size_t worker = 0; worker < task_count; worker++) {
+    tasks.push_back(pool.submit_task([&]() {
+      for (size_t i = next_index++; i < count; i = next_index++) {
+        fn(i);
+      }
+    }));
+  }
+
+  for (auto &task : tasks) {
+    task.get();
+  }
+}
+
+uint32_t GeneratorPool::get_thread_count() const noexcept { return static_cast<uint32_t>(generators.size()); }
+
+terrain_stage_times GeneratorPool::get_stage_times() const noexcept {
+  terrain_stage_times total;
+  for (const auto &generator : generators) {
+    const terrain_stage_times times = generator->get_stage_times();
+    for (size_t stage = 0; stage < terrain_stage_count; stage++) {
+      total.nanoseconds[stage] += times.nanoseconds[stage];
+    }
+    total.chunks += times.chunks;
+  }
+  return total;
+}
@@ -0,0 +1,59 @@
+#ifndef WORLD_OF_CUBE_GENERATOR_POOL_HPP
+#define WORLD_OF_CUBE_GENERATOR_POOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "BS_thread_pool.hpp"
+
+// Cube lib
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "vector.hpp"
+
+// Generate chunks concurrently on a thread pool.
+// Each worker owns its own Generator (and so its own FastNoise node tree), only the thread safe column cache is shared.
+class GeneratorPool {
+public:
+  // thread_count = 0: use all hardware threads
+  explicit GeneratorPool(const Generator &settings, uint32_t thread_count = 0);
+
+  ~GeneratorPool();
+
+  GeneratorPool(const GeneratorPool &) = delete;
+  GeneratorPool &operator=(const GeneratorPool &) = delete;
+
+  // Copy seed and noise settings to all workers, must not be called during generateChunks
+  void copy_settings(const Generator &settings);
+
+  // Generate all chunks, the returned vector is in the same order as positions
+  [[nodiscard]] std::vector<std::unique_ptr<Chunk>> generateChunks(const std::vector<benlib::Vector3i> &positions, const bool generate_3d_terrain);
+
+  // Generate a contiguous block of chunks, split in tiles of up to tile_size^3 chunks, one region noise call per tile.
+  // The returned vector is in memory order (x fastest, then y, then z)
+  [[nodiscard]] std::vector<std::unique_ptr<Chunk>> generate_region(const benlib::Vector3i &begin, const benlib::Vector3i &size, const bool generate_3d_terrain,
+                                                                    uint32_t tile_size = 2);
+
+  // Run fn(i) for i in [0, count) on the workers, return when all calls are done
+  void parallel_for(const size_t count, const std::function<void(size_t)> &fn);
+
+  [[nodiscard]] uint32_t get_thread_count() const noexcept;
+
+  // Terrain stage times summed over all workers, must not be called during generation
+  [[nodiscard]] terrain_stage_times get_stage_times() const noexcept;
+
+private:
+  // Place the structure blocks the chunks received from other chunks of the batch, so the result does not depend on the order
+  void apply_pending_decorations(std::vector<std::unique_ptr<Chunk>> &chunks, const bool generate_3d_terrain);
+
+  // Run fn(generator, i) for i in [0, count), generator is the worker's own generator
+  void parallel_for_worker(const size_t count, const std::function<void(Generator &, size_t)> &fn);
+
+  BS::thread_pool pool;
+  std::vector<std::unique_ptr<Generator>> generators;
+};
+
+#endif // WORLD_OF_CUBE_GENERATOR_POOL_HPP
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <utility>
+
+#include "chunk_io.hpp"
+
+void latency_histogram::add(const uint64_t us) noexcept {
+  buckets[std::min<size_t>(static_cast<size_t>(std::bit_width(us)), bucket_count - 1)]++;
+  count++;
+  total_us += us;
+}
+
+uint64_t latency_histogram::quantile_us(const double q) const noexcept {
+  if (count == 0) {
+    return 0;
+  }
+  const uint64_t rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(count - 1)) + 1;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < bucket_count; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return uint64_t{1} << i;
+    }
+  }
+  return uint64_t{1} << (bucket_count - 1);
+}
+
+chunk_io::chunk_io(std::shared_ptr<region_storage> _storage, const std::chrono::milliseconds _write_delay)
+    : storage(std::move(_storage)), write_delay(_write_delay) {
+  io_thread = std::thread(&chunk_io::thread_func, this);
+}
+
+chunk_io::~chunk_io() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    stopping = true;
+  }
+  work_cv.notify_all();
+  if (io_thread.joinable()) {
+    io_thread.join();
+  }
+}
+
+std::future<std::vector<std::unique_ptr<Chunk>>> chunk_io::read(std::vector<benlib::Vector3i> positions) {
+  read_request request;
+  request.positions = std::move(positions);
+  request.submitted = clock::now();
+  std::future<std::vector<std::unique_ptr<Chunk>>> result = request.promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    reads.push_back(std::move(request));
+  }
+  work_cv.notify_all();
+  return result;
+}
+
+void chunk_io::write(std::unique_ptr<Chunk> chunk) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    add_write(std::move(chunk), clock::now());
+  }
+  work_cv.notify_all();
+}
+
+void chunk_io::write(std::vector<std::unique_ptr<Chunk>> chunks) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const clock::time_point now = clock::now();
+    for (auto &current_chunk : chunks) {
+      add_write(std::move(current_chunk), now);
+    }
+  }
+  work_cv.notify_all();
+}
+
+void chunk_io::add_write(std::unique_ptr<Chunk> chunk, const clock::time_point now) {
+  if (chunk == nullptr) {
+    return;
+  }
+  if (writes.empty()) {
+    first_write_time = now;
+  }
+  auto [it, inserted] = writes.try_emplace(chunk_registry::pack(chunk->get_position()), write_request{nullptr, now});
+  if (!inserted) {
+    coalesced_writes++;
+  }
+  // Keep the first submission time, the chunk waited since then
+  it->second.chunk = std::move(chunk);
+}
+
+void chunk_io::flush() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  flush_requests++;
+  work_cv.notify_all();
+  idle_cv.wait(lock, [&] { return writes.empty() && !writing; });
+  flush_requests--;
+}
+
+void chunk_io::thread_func() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    if (!reads.empty()) {
+      process_reads(lock);
+      continue;
+    }
+    if (!writes.empty() && (stopping || flush_requests > 0 || clock::now() >= first_write_time + write_delay)) {
+      process_writes(lock);
+      continue;
+    }
+    if (stopping) {
+      return;
+    }
+    if (writes.empty()) {
+      work_cv.wait(lock);
+    } else {
+      work_cv.wait_until(lock, first_write_time + write_delay);
+    }
+  }
+}
+
+void chunk_io::process_reads(std::unique_lock<std::mutex> &lock) {
+  read_request request = std::move(reads.front());
+  reads.pop_front();
+
+  // Pending chunks are newer than the disk
+  std::vector<std::unique_ptr<Chunk>> chunks(request.positions.size());
+  std::vector<benlib::Vector3i> disk_positions;
+  std::vector<size_t> disk_indices;
+  try {
+    for (size_t i = 0; i < request.positions.size(); i++) {
+      const benlib::Vector3i &pos = request.positions[i];
+      auto it = writes.find(chunk_registry::pack(pos));
+      if (it == writes.end()) {
+        disk_positions.push_back(pos);
+        disk_indices.push_back(i);
+        continue;
+      }
+      chunks[i] = std::make_unique<Chunk>(it->second.chunk->get_storage(), pos.x, pos.y, pos.z);
+      chunks[i]->set_edited(it->second.chunk->is_edited());
+      chunks[i]->set_saved(true);
+    }
+  } catch (...) {
+    request.promise.set_exception(std::current_exception());
+    return;
+  }
+
+  lock.unlock();
+  // A failed read (file system error, baseline generation) goes to the caller through the future, the thread keeps running
+  try {
+    std::vector<std::unique_ptr<Chunk>> loaded_chunks = storage->load_chunks(disk_positions);
+    for (size_t i = 0; i < loaded_chunks.size(); i++) {
+      chunks[disk_indices[i]] = std::move(loaded_chunks[i]);
+    }
+    request.promise.set_value(std::move(chunks));
+  } catch (...) {
+    request.promise.set_exception(std::current_exception());
+  }
+  const uint64_t us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - request.submitted).count());
+  lock.lock();
+
+  read_latency.add(us);
+}
+
+void chunk_io::process_writes(std::unique_lock<std::mutex> &lock) {
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  std::vector<clock::time_point> submitted;
+  chunks.reserve(writes.size());
+  submitted.reserve(writes.size());
+  for (auto &[key, request] : writes) {
+    chunks.push_back(std::move(request.chunk));
+    submitted.push_back(request.submitted);
+  }
+  writes.clear();
+  writing = true;
+
+  lock.unlock();
+  // The batch is dropped if the storage fails, retrying could fail forever
+  bool failed = false;
+  try {
+    storage->save_chunks(chunks);
+  } catch (...) {
+    failed = true;
+  }
+  const clock::time_point now = clock::now();
+  lock.lock();
+
+  writing = false;
+  if (failed) {
+    failed_writes += chunks.size();
+  } else {
+    for (const auto &time : submitted) {
+      write_latency.add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - time).count()));
+    }
+  }
+  idle_cv.notify_all();
+}
+
+latency_histogram chunk_io::get_read_latency() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return read_latency;
+}
+
+latency_histogram chunk_io::get_write_latency() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return write_latency;
+}
+
+size_t chunk_io::get_pending_writes() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return writes.size();
+}
+
+uint64_t chunk_io::get_coalesced_writes() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return coalesced_writes;
+}
+
+uint64_t chunk_io::get_failed_writes() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return failed_writes;
+}
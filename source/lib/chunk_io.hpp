@@ -0,0 +1,123 @@
+#ifndef WORLD_OF_CUBE_CHUNK_IO_HPP
+#define WORLD_OF_CUBE_CHUNK_IO_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Cube lib
+#include "Chunk.hpp"
+#include "chunk_registry.hpp"
+#include "region_file.hpp"
+#include "vector.hpp"
+
+// Distribution of completion latencies, power of two buckets of microseconds
+struct latency_histogram {
+  static constexpr size_t bucket_count = 32;
+
+  // Bucket 0: below 1us, bucket i: [2^(i-1), 2^i) us, the last one is open
+  std::array<uint64_t, bucket_count> buckets = {};
+  uint64_t count = 0;
+  uint64_t total_us = 0;
+
+  void add(uint64_t us) noexcept;
+
+  // Upper bound (us) of the bucket holding the q quantile (0 to 1), 0 if empty
+  [[nodiscard]] uint64_t quantile_us(double q) const noexcept;
+
+  [[nodiscard]] double mean_us() const noexcept { return count == 0 ? 0.0 : static_cast<double>(total_us) / static_cast<double>(count); }
+};
+
+// Chunk reads and writes of a region storage on a dedicated thread, so writes never block the caller (a read still blocks
+// the caller when it waits on the returned future).
+// Reads go first. Writes of the same chunk are coalesced (the last one wins) and wait write_delay to coalesce more,
+// then all pending writes are saved in one batch (one table write per region file).
+// A read of a chunk waiting to be written returns a copy of the pending chunk.
+// Storage errors never stop the thread: a failed read sets the exception of its future, a failed write batch is dropped and counted.
+class chunk_io {
+public:
+  explicit chunk_io(std::shared_ptr<region_storage> _storage, std::chrono::milliseconds _write_delay = std::chrono::milliseconds(100));
+
+  chunk_io(const chunk_io &) = delete;
+  chunk_io &operator=(const chunk_io &) = delete;
+
+  // Write the pending chunks and stop the thread
+  ~chunk_io();
+
+  // Chunks in the same order as positions, nullptr for the chunks not saved. The future throws if the storage failed
+  [[nodiscard]] std::future<std::vector<std::unique_ptr<Chunk>>> read(std::vector<benlib::Vector3i> positions);
+
+  void write(std::unique_ptr<Chunk> chunk);
+
+  void write(std::vector<std::unique_ptr<Chunk>> chunks);
+
+  // Wait until all the writes submitted so far are on disk
+  void flush();
+
+  [[nodiscard]] region_storage &get_storage() noexcept { return *storage; }
+
+  [[nodiscard]] latency_histogram get_read_latency();
+
+  // From the first submission of a chunk to its write on disk
+  [[nodiscard]] latency_histogram get_write_latency();
+
+  [[nodiscard]] size_t get_pending_writes();
+
+  // Writes replaced by a newer write of the same chunk before reaching the disk
+  [[nodiscard]] uint64_t get_coalesced_writes();
+
+  // Chunks of the write batches the storage failed to save
+  [[nodiscard]] uint64_t get_failed_writes();
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  struct read_request {
+    std::vector<benlib::Vector3i> positions;
+    std::promise<std::vector<std::unique_ptr<Chunk>>> promise;
+    clock::time_point submitted;
+  };
+
+  struct write_request {
+    std::unique_ptr<Chunk> chunk;
+    clock::time_point submitted;
+  };
+
+  void thread_func();
+
+  // Reads and pending writes, call with _mutex locked
+  void add_write(std::unique_ptr<Chunk> chunk, clock::time_point now);
+  void process_reads(std::unique_lock<std::mutex> &lock);
+  void process_writes(std::unique_lock<std::mutex> &lock);
+
+  std::shared_ptr<region_storage> storage;
+  std::chrono::milliseconds write_delay;
+
+  std::mutex _mutex;
+  std::condition_variable work_cv;
+  std::condition_variable idle_cv;
+  std::deque<read_request> reads;
+  std::unordered_map<chunk_registry::key_t, write_request> writes;
+  // Submission of the oldest pending write
+  clock::time_point first_write_time;
+  bool writing = false;
+  size_t flush_requests = 0;
+  bool stopping = false;
+
+  latency_histogram read_latency;
+  latency_histogram write_latency;
+  uint64_t coalesced_writes = 0;
+  uint64_t failed_writes = 0;
+
+  std::thread io_thread;
+};
+
+#endif // WORLD_OF_CUBE_CHUNK_IO_HPP
@@ -0,0 +1,126 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "chunk_occupancy.hpp"
+#include "world_model.hpp"
+
+namespace {
+// Bit i of the result is set if byte i of the 32 bytes is not 0 (little endian)
+inline uint32_t pack_non_zero_bytes(const uint8_t *bytes) noexcept {
+  uint32_t bits = 0;
+  for (int i = 0; i < 4; i++) {
+    uint64_t v;
+    std::memcpy(&v, bytes + i * 8, sizeof(v));
+    // High bit of each byte set if the byte is not 0, then gather the 8 high bits in the top byte
+    const uint64_t high_bits = (((v & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | v) & 0x8080808080808080ULL;
+    bits |= static_cast<uint32_t>(((high_bits >> 7) * 0x0102040810204080ULL) >> 56) << (i * 8);
+  }
+  return bits;
+}
+
+// Transpose a 32x32 bit matrix: bit j of a[i] becomes bit i of a[j]
+inline void transpose32(uint32_t a[32]) noexcept {
+  uint32_t m = 0x0000FFFFu;
+  for (int j = 16; j != 0; j >>= 1, m ^= (m << j)) {
+    for (int k = 0; k < 32; k = ((k | j) + 1) & ~j) {
+      const uint32_t t = ((a[k] >> j) ^ a[k | j]) & m;
+      a[k] ^= t << j;
+      a[k | j] ^= t;
+    }
+  }
+}
+} // namespace
+
+const std::shared_ptr<const chunk_occupancy> &chunk_occupancy::uniform(const bool solid) {
+  static const std::shared_ptr<const chunk_occupancy> empty = std::make_shared<const chunk_occupancy>();
+  static const std::shared_ptr<const chunk_occupancy> full = [] {
+    auto occupancy = std::make_shared<chunk_occupancy>();
+    occupancy->rows.fill(~0u);
+    return std::shared_ptr<const chunk_occupancy>(std::move(occupancy));
+  }();
+  return solid ? full : empty;
+}
+
+std::shared_ptr<const chunk_occupancy> chunk_occupancy::make_shared(Chunk &chunk) {
+  if (chunk.is_uniform()) {
+    return uniform(chunk.get_uniform_block().block_type != block_type::air);
+  }
+  return std::make_shared<const chunk_occupancy>(build(chunk));
+}
+
+chunk_occupancy chunk_occupancy::build(Chunk &chunk) noexcept {
+  static_assert(sizeof(block_type::block_t) == sizeof(uint8_t), "Blocks are read as bytes");
+  static_assert(Chunk::chunk_size_x == 32, "One x row must fit in a uint32_t");
+
+  chunk_occupancy occupancy;
+  // Blocks are palette packed, unpack them once in memory order
+  thread_local std::vector<uint8_t> unpacked;
+  unpacked.resize(chunk.size());
+  chunk.get_storage().unpack(unpacked.data());
+  const uint8_t *bytes = unpacked.data();
+
+  for (int y = 0; y < Chunk::chunk_size_y; y++) {
+    // x rows of the (x, z) plane, packed from memory order (x fastest), then transposed into z rows
+    uint32_t plane[32];
+    for (int z = 0; z < Chunk::chunk_size_z; z++) {
+      plane[z] = pack_non_zero_bytes(bytes + math::convert_to_1d(0, y, z, Chunk::chunk_size_x, Chunk::chunk_size_y, Chunk::chunk_size_z));
+    }
+    transpose32(plane);
+    for (int x = 0; x < Chunk::chunk_size_x; x++) {
+      occupancy.rows[x * Chunk::chunk_size_y + y] = plane[x];
+    }
+  }
+  return occupancy;
+}
+
+void chunk_occupancy::row_faces(const int x, const int y, uint32_t faces[6], const chunk_occupancy *const *neighbours) const noexcept {
+  constexpr int size_x = Chunk::chunk_size_x;
+  constexpr int size_y = Chunk::chunk_size_y;
+  const auto neighbour = [neighbours](const size_t face) -> const chunk_occupancy * { return neighbours == nullptr ? nullptr : neighbours[face]; };
+
+  const chunk_occupancy *south = neighbour(world_model::south_face);
+  const chunk_occupancy *north = neighbour(world_model::north_face);
+  const chunk_occupancy *west = neighbour(world_model::west_face);
+  const chunk_occupancy *east = neighbour(world_model::east_face);
+  const chunk_occupancy *up = neighbour(world_model::up_face);
+  const chunk_occupancy *down = neighbour(world_model::down_face);
+
+  const uint32_t current = row(x, y);
+
+  // Solid blocks next to the row, read in the neighbour chunk on the borders (not solid if not loaded)
+  const uint32_t south_border = south != nullptr ? (south->row(x, y) & 1u) << 31 : 0;
+  const uint32_t north_border = north != nullptr ? (north->row(x, y) >> 31) : 0;
+  const uint32_t west_row = x + 1 < size_x ? row(x + 1, y) : (west != nullptr ? west->row(0, y) : 0);
+  const uint32_t east_row = x > 0 ? row(x - 1, y) : (east != nullptr ? east->row(size_x - 1, y) : 0);
+  const uint32_t up_row = y + 1 < size_y ? row(x, y + 1) : (up != nullptr ? up->row(x, 0) : 0);
+  const uint32_t down_row = y > 0 ? row(x, y - 1) : (down != nullptr ? down->row(x, size_y - 1) : 0);
+
+  faces[world_model::south_face] = current & ~((current >> 1) | south_border);
+  faces[world_model::north_face] = current & ~((current << 1) | north_border);
+  faces[world_model::west_face] = current & ~west_row;
+  faces[world_model::east_face] = current & ~east_row;
+  faces[world_model::up_face] = current & ~up_row;
+  faces[world_model::down_face] = current & ~down_row;
+
+  // Blocks with all known neighbours solid have no face at all, the borders without loaded neighbour chunk
+  // are counted as solid (see world_model::generate_chunk_mesh)
+  uint32_t exposed = (faces[world_model::south_face] & (south != nullptr ? ~0u : 0x7FFFFFFFu)) |
+                     (faces[world_model::north_face] & (north != nullptr ? ~0u : ~1u));
+  if (x + 1 < size_x || west != nullptr) {
+    exposed |= faces[world_model::west_face];
+  }
+  if (x > 0 || east != nullptr) {
+    exposed |= faces[world_model::east_face];
+  }
+  if (y + 1 < size_y || up != nullptr) {
+    exposed |= faces[world_model::up_face];
+  }
+  if (y > 0 || down != nullptr) {
+    exposed |= faces[world_model::down_face];
+  }
+
+  for (size_t face = 0; face < 6; face++) {
+    faces[face] &= exposed;
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef WORLD_OF_CUBE_CHUNK_OCCUPANCY_HPP
+#define WORLD_OF_CUBE_CHUNK_OCCUPANCY_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+// Cube lib
+#include "Chunk.hpp"
+
+// Solid blocks of a chunk, one bit per block: rows[x * size_y + y] bit z is set if the block (x, y, z) is not air
+struct chunk_occupancy {
+  static_assert(Chunk::chunk_size_z == 32, "One occupancy row must fit in a uint32_t");
+
+  std::array<uint32_t, Chunk::chunk_size_x * Chunk::chunk_size_y> rows = {};
+
+  [[nodiscard]] static chunk_occupancy build(Chunk &chunk) noexcept;
+
+  // Shared occupancy of all empty (all air) or all full chunks
+  [[nodiscard]] static const std::shared_ptr<const chunk_occupancy> &uniform(bool solid);
+
+  // Occupancy of the chunk, shared for uniform chunks
+  [[nodiscard]] static std::shared_ptr<const chunk_occupancy> make_shared(Chunk &chunk);
+
+  [[nodiscard]] inline uint32_t row(const int x, const int y) const noexcept {
+    if (x < 0 || x >= Chunk::chunk_size_x || y < 0 || y >= Chunk::chunk_size_y) {
+      return 0;
+    }
+    return rows[x * Chunk::chunk_size_y + y];
+  }
+
+  // Visible faces of the row (x, y), indexed by world_model face, bit z set if the face of block (x, y, z) is visible.
+  // neighbours (indexed by world_model face, nullptr if not loaded) are used to cull faces on the chunk borders,
+  // without neighbour the blocks outside of the chunk are not solid
+  void row_faces(const int x, const int y, uint32_t faces[6], const chunk_occupancy *const *neighbours = nullptr) const noexcept;
+};
+
+#endif // WORLD_OF_CUBE_CHUNK_OCCUPANCY_HPP
@@ -0,0 +1,197 @@
+#ifndef WORLD_OF_CUBE_CHUNK_REGISTRY_HPP
+#define WORLD_OF_CUBE_CHUNK_REGISTRY_HPP
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Cube lib
+#include "Chunk.hpp"
+#include "vector.hpp"
+
+// Owns the loaded chunks and indexes them by chunk coordinates.
+// Chunks are stored densely (cache friendly iteration for rendering), the open-addressing index (linear probing,
+// backward shift deletion) maps packed coordinates to their slot in the dense storage, so lookup/insert/erase are O(1).
+// Not thread safe: callers must hold the owner's mutex.
+class chunk_registry {
+public:
+  using key_t = uint64_t;
+  using container_t = std::vector<std::unique_ptr<Chunk>>;
+
+  chunk_registry() { rehash(min_capacity); }
+
+  // Pack chunk coordinates on 21 bits each (+/- 1M chunks per axis)
+  [[nodiscard]] static inline constexpr key_t pack(const int32_t x, const int32_t y, const int32_t z) noexcept {
+    return (static_cast<key_t>(static_cast<uint32_t>(x) & coord_mask) << 42) | (static_cast<key_t>(static_cast<uint32_t>(y) & coord_mask) << 21) |
+           (static_cast<key_t>(static_cast<uint32_t>(z) & coord_mask));
+  }
+
+  [[nodiscard]] static inline constexpr key_t pack(const benlib::Vector3i &pos) noexcept { return pack(pos.x, pos.y, pos.z); }
+
+  // splitmix64 finalizer, the index slot of a key is hash(key) & (capacity - 1)
+  [[nodiscard]] static inline constexpr key_t hash(key_t key) noexcept {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+  }
+
+  [[nodiscard]] inline Chunk *find(const int32_t x, const int32_t y, const int32_t z) const noexcept {
+    const size_t slot = find_slot(pack(x, y, z));
+    return slot == npos ? nullptr : chunks[index[slot].value].get();
+  }
+
+  [[nodiscard]] inline Chunk *find(const benlib::Vector3i &pos) const noexcept { return find(pos.x, pos.y, pos.z); }
+
+  [[nodiscard]] inline bool contains(const int32_t x, const int32_t y, const int32_t z) const noexcept { return find_slot(pack(x, y, z)) != npos; }
+
+  [[nodiscard]] inline bool contains(const benlib::Vector3i &pos) const noexcept { return contains(pos.x, pos.y, pos.z); }
+
+  // Insert the chunk at its own position, return false if there is none or a chunk already exists there.
+  // The chunk is only moved from when inserted, a rejected chunk stays with the caller
+  bool insert(std::unique_ptr<Chunk> &&chunk) {
+    if (chunk == nullptr) {
+      return false;
+    }
+    const key_t key = pack(chunk->get_position());
+    if (find_slot(key) != npos) {
+      return false;
+    }
+    if ((chunks.size() + 1) * max_load_den > index.size() * max_load_num) {
+      rehash(index.size() * 2);
+    }
+    insert_index(key, static_cast<uint32_t>(chunks.size()));
+    chunks.push_back(std::move(chunk));
+    return true;
+  }
+
+  bool erase(const int32_t x, const int32_t y, const int32_t z) {
+    const size_t slot = find_slot(pack(x, y, z));
+    if (slot == npos) {
+      return false;
+    }
+    erase_at(slot);
+    return true;
+  }
+
+  bool erase(const benlib::Vector3i &pos) { return erase(pos.x, pos.y, pos.z); }
+
+  // Erase all chunks matching the predicate, return the number of erased chunks
+  template <typename Predicate> size_t erase_if(Predicate pred) {
+    size_t count = 0;
+    for (size_t i = 0; i < chunks.size();) {
+      if (chunks[i] == nullptr || !pred(*chunks[i])) {
+        i++;
+        continue;
+      }
+      // The last chunk is moved at i, so i is checked again
+      erase_at(find_slot(pack(chunks[i]->get_position())));
+      count++;
+    }
+    return count;
+  }
+
+  void clear() {
+    chunks.clear();
+    rehash(min_capacity);
+  }
+
+  void reserve(const size_t count) {
+    chunks.reserve(count);
+    size_t capacity = index.size();
+    while (count * max_load_den > capacity * max_load_num) {
+      capacity *= 2;
+    }
+    if (capacity != index.size()) {
+      rehash(capacity);
+    }
+  }
+
+  [[nodiscard]] inline size_t size() const noexcept { return chunks.size(); }
+
+  [[nodiscard]] inline bool empty() const noexcept { return chunks.empty(); }
+
+  // Slots of the index, a power of two
+  [[nodiscard]] inline size_t capacity() const noexcept { return index.size(); }
+
+  inline container_t::iterator begin() noexcept { return chunks.begin(); }
+  inline container_t::iterator end() noexcept { return chunks.end(); }
+  inline container_t::const_iterator begin() const noexcept { return chunks.begin(); }
+  inline container_t::const_iterator end() const noexcept { return chunks.end(); }
+
+private:
+  struct slot_t {
+    key_t key = empty_key;
+    uint32_t value = 0;
+  };
+
+  static constexpr uint32_t coord_mask = (1u << 21) - 1;
+  // Packed keys use 63 bits, so this value is never a valid key
+  static constexpr key_t empty_key = std::numeric_limits<key_t>::max();
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+  static constexpr size_t min_capacity = 64;
+  // Max load factor: 7/10
+  static constexpr size_t max_load_num = 7;
+  static constexpr size_t max_load_den = 10;
+
+  [[nodiscard]] inline size_t find_slot(const key_t key) const noexcept {
+    const size_t mask = index.size() - 1;
+    for (size_t slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+      if (index[slot].key == key) {
+        return slot;
+      }
+      if (index[slot].key == empty_key) {
+        return npos;
+      }
+    }
+  }
+
+  inline void insert_index(const key_t key, const uint32_t value) noexcept {
+    const size_t mask = index.size() - 1;
+    size_t slot = hash(key) & mask;
+    while (index[slot].key != empty_key) {
+      slot = (slot + 1) & mask;
+    }
+    index[slot] = {key, value};
+  }
+
+  void erase_at(size_t slot) {
+    const uint32_t value = index[slot].value;
+
+    // Backward shift deletion, keep probe sequences without tombstones
+    const size_t mask = index.size() - 1;
+    for (size_t next = (slot + 1) & mask; index[next].key != empty_key; next = (next + 1) & mask) {
+      const size_t ideal = hash(index[next].key) & mask;
+      // Move next into the hole if the hole is between its ideal slot and itself (cyclically)
+      if (((next - ideal) & mask) >= ((next - slot) & mask)) {
+        index[slot] = index[next];
+        slot = next;
+      }
+    }
+    index[slot].key = empty_key;
+
+    // Swap and pop the dense storage, fix the index of the moved chunk
+    const uint32_t last = static_cast<uint32_t>(chunks.size() - 1);
+    if (value != last) {
+      chunks[value] = std::move(chunks[last]);
+      index[find_slot(pack(chunks[value]->get_position()))].value = value;
+    }
+    chunks.pop_back();
+  }
+
+  void rehash(const size_t capacity) {
+    index.assign(capacity, slot_t{});
+    for (uint32_t i = 0; i < chunks.size(); i++) {
+      insert_index(pack(chunks[i]->get_position()), i);
+    }
+  }
+
+  container_t chunks;
+  std::vector<slot_t> index;
+};
+
+#endif // WORLD_OF_CUBE_CHUNK_REGISTRY_HPP
@@ -0,0 +1,106 @@
+#ifndef WORLD_OF_CUBE_CHUNK_SCHEDULER_HPP
+#define WORLD_OF_CUBE_CHUNK_SCHEDULER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Raylib
+#include "raylib.h"
+
+// Cube lib
+#include "vector.hpp"
+
+// Min-heap of pending chunk positions, ordered by distance to the center (player chunk).
+// Chunks in the view direction can be favored with view_bias (0: distance only, 1: chunks behind cost twice as much).
+// Not thread safe.
+class chunk_scheduler {
+public:
+  struct entry_t {
+    float priority;
+    benlib::Vector3i pos;
+  };
+
+  chunk_scheduler() = default;
+
+  explicit chunk_scheduler(const float _view_bias) : view_bias(_view_bias) {}
+
+  // Set the center and the view direction, re-prioritize pending chunks if the center changed.
+  // Return true if the center changed
+  bool set_center(const benlib::Vector3i &_center, const Vector3 &_view_direction) {
+    const bool center_changed = _center.x != center.x || _center.y != center.y || _center.z != center.z;
+    center = _center;
+    view_direction = normalize(_view_direction);
+
+    if (center_changed) {
+      for (auto &entry : heap) {
+        entry.priority = priority(entry.pos);
+      }
+      std::make_heap(heap.begin(), heap.end(), compare);
+    }
+    return center_changed;
+  }
+
+  void push(const benlib::Vector3i &pos) {
+    heap.push_back({priority(pos), pos});
+    std::push_heap(heap.begin(), heap.end(), compare);
+  }
+
+  // Pop the closest pending chunk, return false if the queue is empty
+  bool pop(benlib::Vector3i &pos) {
+    if (heap.empty()) {
+      return false;
+    }
+    std::pop_heap(heap.begin(), heap.end(), compare);
+    pos = heap.back().pos;
+    heap.pop_back();
+    return true;
+  }
+
+  void clear() noexcept { heap.clear(); }
+
+  [[nodiscard]] inline size_t size() const noexcept { return heap.size(); }
+
+  [[nodiscard]] inline bool empty() const noexcept { return heap.empty(); }
+
+  [[nodiscard]] inline const benlib::Vector3i &get_center() const noexcept { return center; }
+
+  inline void set_view_bias(const float _view_bias) noexcept { view_bias = _view_bias; }
+
+  [[nodiscard]] inline float get_view_bias() const noexcept { return view_bias; }
+
+  [[nodiscard]] float priority(const benlib::Vector3i &pos) const noexcept {
+    const float dx = static_cast<float>(pos.x - center.x);
+    const float dy = static_cast<float>(pos.y - center.y);
+    const float dz = static_cast<float>(pos.z - center.z);
+    const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    if (view_bias <= 0.0f || distance == 0.0f) {
+      return distance;
+    }
+    // cos = 1 in front of the camera, -1 behind
+    const float cos = (dx * view_direction.x + dy * view_direction.y + dz * view_direction.z) / distance;
+    return distance * (1.0f + view_bias * (1.0f - cos) * 0.5f);
+  }
+
+private:
+  // std heap functions build a max-heap, invert to get the closest chunk first
+  static inline bool compare(const entry_t &a, const entry_t &b) noexcept { return a.priority > b.priority; }
+
+  static inline Vector3 normalize(const Vector3 &v) noexcept {
+    const float length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    if (length == 0.0f) {
+      return {0.0f, 0.0f, 0.0f};
+    }
+    return {v.x / length, v.y / length, v.z / length};
+  }
+
+  std::vector<entry_t> heap;
+  benlib::Vector3i center = {0, 0, 0};
+  Vector3 view_direction = {0.0f, 0.0f, 0.0f};
+  float view_bias = 0.0f;
+};
+
+#endif // WORLD_OF_CUBE_CHUNK_SCHEDULER_HPP
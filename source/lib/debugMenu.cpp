@@ -32,8 +32,8 @@ void debugMenu::updateDraw2d() {
     return;
   }
 
-  DrawRectangle(4, 4, 370, 290, Fade(SKYBLUE, 0.5f));
-  DrawRectangleLines(4, 4, 370, 290, BLUE);
+  DrawRectangle(4, 4, 370, 490, Fade(SKYBLUE, 0.5f));
+  DrawRectangleLines(4, 4, 370, 490, BLUE);
 
   // Draw FPS
   DrawFPS(8, 8);
@@ -65,6 +65,28 @@ void debugMenu::updateDraw2d() {
             ", " + std::to_string(_game_context_ref.player_chunk_pos.z))
                .c_str(),
            10, 270, 20, BLACK);
+
+  // Draw chunk generation stats
+  DrawText(("Generation queue: " + std::to_string(_game_context_ref.generation_queue_size)).c_str(), 10, 310, 20, BLACK);
+  DrawText(("First visible chunk: " + std::to_string(static_cast<int32_t>(_game_context_ref.time_to_first_visible_chunk_ms)) + "ms").c_str(), 10, 330, 20,
+           BLACK);
+  DrawText(("Upload queue: " + std::to_string(_game_context_ref.upload_queue_size)).c_str(), 10, 350, 20, BLACK);
+  DrawText(("Uploads per frame: " + std::to_string(_game_context_ref.uploads_per_frame) + " (" +
+            std::to_string(_game_context_ref.upload_bytes_per_frame / 1024) + " KB)")
+               .c_str(),
+           10, 370, 20, BLACK);
+  DrawText(("Chunk memory: " + std::to_string(_game_context_ref.chunk_memory_bytes / (1024 * 1024)) + " MB").c_str(), 10, 390, 20, BLACK);
+  DrawText(("Uniform chunks: " + std::to_string(_game_context_ref.uniform_chunk_count)).c_str(), 10, 410, 20, BLACK);
+  const auto &stage_us = _game_context_ref.generation_stage_us;
+  DrawText(("Stages us: " + std::to_string(static_cast<int32_t>(stage_us[0])) + " " + std::to_string(static_cast<int32_t>(stage_us[1])) + " " +
+            std::to_string(static_cast<int32_t>(stage_us[2])) + " " + std::to_string(static_cast<int32_t>(stage_us[3])) + " " +
+            std::to_string(static_cast<int32_t>(stage_us[4])))
+               .c_str(),
+           10, 430, 20, BLACK);
+  DrawText(("I/O p99 us: read " + std::to_string(_game_context_ref.io_read_p99_us) + " write " + std::to_string(_game_context_ref.io_write_p99_us) +
+            " (" + std::to_string(_game_context_ref.io_pending_writes) + " pending, " + std::to_string(_game_context_ref.io_failed_writes) + " failed)")
+               .c_str(),
+           10, 450, 20, BLACK);
   bool forceSquaredChecked = false;
   // GuiCheckBox((Rectangle){ 25, 108, 15, 15 }, "FORCE CHECK!", &forceSquaredChecked);
 
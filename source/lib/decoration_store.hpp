@@ -0,0 +1,90 @@
+#ifndef WORLD_OF_CUBE_DECORATION_STORE_HPP
+#define WORLD_OF_CUBE_DECORATION_STORE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Cube lib
+#include "block_type.hpp"
+#include "chunk_registry.hpp"
+#include "vector.hpp"
+
+// Block of a structure (tree...) to place in another chunk than the one that seeded it
+struct pending_block {
+  // Block index in the target chunk, in memory order
+  uint16_t index;
+  block_type::block_t block_type;
+};
+
+// Pending decoration blocks keyed by target chunk, then by source chunk. A source replaces its previous blocks when it is
+// generated again, so the store does not grow when chunks are reloaded. Targets that received blocks since the last
+// take_dirty() are tracked, so already loaded chunks can be updated.
+// Thread safe, can be shared by the generators of a pool.
+class decoration_store {
+public:
+  using key_t = chunk_registry::key_t;
+
+  void set(const benlib::Vector3i &target, const benlib::Vector3i &source, std::vector<pending_block> blocks) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto &target_entry = entries[chunk_registry::pack(target)];
+    target_entry.pos = target;
+    target_entry.sources[chunk_registry::pack(source)] = std::move(blocks);
+    dirty.push_back(target);
+  }
+
+  // All blocks pending for the target chunk, from every source
+  [[nodiscard]] std::vector<pending_block> get(const benlib::Vector3i &target) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<pending_block> blocks;
+    auto it = entries.find(chunk_registry::pack(target));
+    if (it == entries.end()) {
+      return blocks;
+    }
+    for (const auto &source : it->second.sources) {
+      blocks.insert(blocks.end(), source.second.begin(), source.second.end());
+    }
+    return blocks;
+  }
+
+  // Targets that received blocks since the last call (may contain duplicates)
+  [[nodiscard]] std::vector<benlib::Vector3i> take_dirty() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return std::exchange(dirty, {});
+  }
+
+  // Drop the targets for which fn(target) is true
+  void erase_if(const std::function<bool(const benlib::Vector3i &)> &fn) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+      it = fn(it->second.pos) ? entries.erase(it) : std::next(it);
+    }
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    entries.clear();
+    dirty.clear();
+  }
+
+  // Number of target chunks with pending blocks
+  [[nodiscard]] size_t size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return entries.size();
+  }
+
+private:
+  struct target_entry_t {
+    benlib::Vector3i pos;
+    std::unordered_map<key_t, std::vector<pending_block>> sources;
+  };
+
+  mutable std::mutex _mutex;
+  std::unordered_map<key_t, target_entry_t> entries;
+  std::vector<benlib::Vector3i> dirty;
+};
+
+#endif // WORLD_OF_CUBE_DECORATION_STORE_HPP
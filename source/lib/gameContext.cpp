@@ -1,4 +1,5 @@
 #include "gameContext.hpp"
+#include "world_model.hpp"
 
 gameContext::gameContext(std::vector<std::shared_ptr<gameElementHandler>> &_game_classes, nlohmann::json &_config_json)
     : game_classes(_game_classes), _configJson(_config_json) {
@@ -29,10 +30,23 @@ void gameContext::updateDraw3d() {}
 
 void gameContext::updateDrawInterface() {}
 
-void gameContext::unload_texture() { UnloadTexture(_texture); }
+void gameContext::unload_texture() {
+  UnloadTexture(_texture);
+  UnloadTexture(_block_tile_texture);
+}
 
 void gameContext::load_texture() {
-  _texture = LoadTexture("grass.png");
+  Image atlas = LoadImage("grass.png");
+  _texture = LoadTextureFromImage(atlas);
+
+  const Rectangle tile = world_model::atlas_block_tile;
+  const auto width = static_cast<float>(atlas.width);
+  const auto height = static_cast<float>(atlas.height);
+  Image block_tile = ImageFromImage(atlas, Rectangle{tile.x * width, tile.y * height, tile.width * width, tile.height * height});
+  _block_tile_texture = LoadTextureFromImage(block_tile);
+  SetTextureWrap(_block_tile_texture, TEXTURE_WRAP_REPEAT);
+  UnloadImage(block_tile);
+  UnloadImage(atlas);
   // Image img = GenImageChecked(256, 256, 32, 32, GREEN, RED);
   // Image img = GenImageColor(16, 16, WHITE);
   // Texture2D textureGrid = LoadTextureFromImage(img);
@@ -1,6 +1,7 @@
 #ifndef WORLD_OF_CUBE_GAME_CONTEXT_HPP
 #define WORLD_OF_CUBE_GAME_CONTEXT_HPP
 
+#include <array>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -49,10 +50,13 @@ public:
 
   Vector3 player_pos = {0, 0, 0};
   benlib::Vector3i player_chunk_pos = {0, 0, 0};
+  Vector3 player_view_direction = {0, 0, 1};
 
   benlib::Vector3i block_info_pos = {0, 0, 0};
   size_t block_info_index = 0;
   Texture2D _texture;
+  // Block tile of _texture alone, repeated across the merged faces of the greedy mesher
+  Texture2D _block_tile_texture;
 
   // Stats
   size_t vectices_on_world_count = 0;
@@ -64,6 +68,30 @@ public:
   size_t vectices_on_screen_count = 0;
   size_t triangles_on_screen_count = 0;
 
+  // Chunk generation stats
+  size_t generation_queue_size = 0;
+  // Time from world (re)load to the first chunk generated and the first chunk with a model, -1 if not reached yet
+  double time_to_first_chunk_ms = -1.0;
+  double time_to_first_visible_chunk_ms = -1.0;
+  // Mean time per chunk of each terrain stage (density, surface, water, caves, decoration)
+  std::array<double, 5> generation_stage_us = {};
+
+  // Chunk I/O thread: completion latency (99th percentile, power of two bucket) and writes waiting
+  uint64_t io_read_p99_us = 0;
+  uint64_t io_write_p99_us = 0;
+  size_t io_pending_writes = 0;
+  uint64_t io_failed_writes = 0;
+
+  // GPU upload stats (last frame)
+  size_t upload_queue_size = 0;
+  size_t uploads_per_frame = 0;
+  size_t upload_bytes_per_frame = 0;
+
+  // Block storage of the loaded chunks
+  size_t chunk_memory_bytes = 0;
+  // Loaded chunks with a single block type (no block index, no mesh if all air)
+  size_t uniform_chunk_count = 0;
+
   nlohmann::json &_configJson;
 
   std::vector<std::shared_ptr<gameElementHandler>> &game_classes;
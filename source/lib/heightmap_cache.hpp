@@ -0,0 +1,121 @@
+#ifndef WORLD_OF_CUBE_HEIGHTMAP_CACHE_HPP
+#define WORLD_OF_CUBE_HEIGHTMAP_CACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Bounded LRU cache of 2D heightmaps, one per chunk column (x, z) and seed, so the chunks stacked in a column
+// compute their 2D noise once. The other noise settings are part of the key, entries of old settings just age out.
+// Thread safe, can be shared by the generators of a pool.
+class heightmap_cache {
+public:
+  using heightmap_t = std::shared_ptr<const std::vector<uint32_t>>;
+
+  struct key_t {
+    int32_t x;
+    int32_t z;
+    uint32_t seed;
+    uint64_t settings;
+
+    inline bool operator==(const key_t &other) const noexcept { return x == other.x && z == other.z && seed == other.seed && settings == other.settings; }
+  };
+
+  explicit heightmap_cache(const size_t _capacity = 1024) : capacity(_capacity) {}
+
+  // Return the cached heightmap (and mark it as recently used), nullptr if missing
+  heightmap_t get(const key_t &key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+      misses++;
+      return nullptr;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+  }
+
+  void put(const key_t &key, heightmap_t heightmap) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (capacity == 0) {
+      return;
+    }
+    auto it = index.find(key);
+    if (it != index.end()) {
+      it->second->second = std::move(heightmap);
+      entries.splice(entries.begin(), entries, it->second);
+      return;
+    }
+    // Evict the least recently used column
+    if (entries.size() >= capacity) {
+      index.erase(entries.back().first);
+      entries.pop_back();
+    }
+    entries.emplace_front(key, std::move(heightmap));
+    index[key] = entries.begin();
+  }
+
+  // Drop all heightmaps, keep the statistics
+  void clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    entries.clear();
+    index.clear();
+  }
+
+  void set_capacity(const size_t _capacity) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    capacity = _capacity;
+    while (entries.size() > capacity) {
+      index.erase(entries.back().first);
+      entries.pop_back();
+    }
+  }
+
+  [[nodiscard]] size_t get_capacity() const noexcept { return capacity; }
+
+  [[nodiscard]] size_t size() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return entries.size();
+  }
+
+  [[nodiscard]] uint64_t get_hits() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return hits;
+  }
+
+  [[nodiscard]] uint64_t get_misses() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return misses;
+  }
+
+  // Hits / lookups, 0 if no lookup yet
+  [[nodiscard]] double hit_rate() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+  }
+
+private:
+  struct key_hash {
+    inline size_t operator()(const key_t &key) const noexcept {
+      uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(key.x)) << 32) | static_cast<uint32_t>(key.z);
+      h ^= (static_cast<uint64_t>(key.seed) ^ key.settings) * 0x9E3779B97F4A7C15ULL;
+      h ^= h >> 31;
+      return static_cast<size_t>(h * 0xBF58476D1CE4E5B9ULL);
+    }
+  };
+
+  using entry_t = std::pair<key_t, heightmap_t>;
+
+  std::mutex _mutex;
+  std::list<entry_t> entries;
+  std::unordered_map<key_t, std::list<entry_t>::iterator, key_hash> index;
+  size_t capacity;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+};
+
+#endif // WORLD_OF_CUBE_HEIGHTMAP_CACHE_HPP
@@ -0,0 +1,46 @@
+#include "mapped_file.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool mapped_file::map(const std::filesystem::path &path) {
+  unmap();
+#if defined(__unix__) || defined(__APPLE__)
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat = {};
+  if (::fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  void *mapping = ::mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps its own reference to the file
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+  _data = static_cast<const uint8_t *>(mapping);
+  _size = static_cast<size_t>(file_stat.st_size);
+  return true;
+#else
+  (void)path;
+  return false;
+#endif
+}
+
+void mapped_file::unmap() noexcept {
+  if (_data == nullptr) {
+    return;
+  }
+#if defined(__unix__) || defined(__APPLE__)
+  ::munmap(const_cast<uint8_t *>(_data), _size);
+#endif
+  _data = nullptr;
+  _size = 0;
+}
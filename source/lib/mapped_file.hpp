@@ -0,0 +1,42 @@
+#ifndef WORLD_OF_CUBE_MAPPED_FILE_HPP
+#define WORLD_OF_CUBE_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Read only memory mapping of a whole file. Only available on POSIX systems, map() always fails elsewhere
+class mapped_file {
+public:
+  mapped_file() = default;
+
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  ~mapped_file() { unmap(); }
+
+  // Map the current content of the file, return false if the file cannot be mapped
+  bool map(const std::filesystem::path &path);
+
+  void unmap() noexcept;
+
+  [[nodiscard]] static constexpr bool is_supported() noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  [[nodiscard]] inline const uint8_t *data() const noexcept { return _data; }
+
+  [[nodiscard]] inline size_t size() const noexcept { return _size; }
+
+  [[nodiscard]] inline bool is_mapped() const noexcept { return _data != nullptr; }
+
+private:
+  const uint8_t *_data = nullptr;
+  size_t _size = 0;
+};
+
+#endif // WORLD_OF_CUBE_MAPPED_FILE_HPP
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "palette_storage.hpp"
+
+palette_storage::palette_storage(const size_t _count, const block_t fill) : palette{fill}, count(_count) {}
+
+palette_storage::palette_storage(const std::vector<Block> &blocks) : count(blocks.size()) {
+  if (blocks.empty()) {
+    return;
+  }
+
+  // Palette sorted by block type, lookup table from block type to palette index
+  std::array<bool, 256> used = {};
+  for (const auto &block : blocks) {
+    used[block.block_type] = true;
+  }
+  std::array<uint8_t, 256> lookup = {};
+  for (size_t type = 0; type < used.size(); type++) {
+    if (used[type]) {
+      lookup[type] = static_cast<uint8_t>(palette.size());
+      palette.push_back(static_cast<block_t>(type));
+    }
+  }
+
+  bits = bits_for(palette.size());
+  if (bits == 0) {
+    return;
+  }
+  words.assign((count * bits + 63) / 64, 0);
+  for (size_t i = 0; i < count; i++) {
+    const size_t bit = i * bits;
+    words[bit >> 6] |= static_cast<uint64_t>(lookup[blocks[i].block_type]) << (bit & 63);
+  }
+}
+
+palette_storage::palette_storage(std::vector<block_t> _palette, std::vector<uint64_t> _words, const size_t _count)
+    : palette(std::move(_palette)), words(std::move(_words)), count(_count), bits(bits_for(palette.size())) {}
+
+size_t palette_storage::word_count(const size_t _count, const size_t palette_size) noexcept { return (_count * bits_for(palette_size) + 63) / 64; }
+
+uint8_t palette_storage::bits_for(const size_t palette_size) noexcept {
+  if (palette_size <= 1) {
+    return 0;
+  }
+  uint8_t bits = 1;
+  while ((size_t{1} << bits) < palette_size) {
+    bits *= 2;
+  }
+  return bits;
+}
+
+void palette_storage::set(const size_t index, const block_t type) {
+  auto it = std::find(palette.begin(), palette.end(), type);
+  size_t palette_index = static_cast<size_t>(it - palette.begin());
+  if (it == palette.end()) {
+    palette.push_back(type);
+    const uint8_t new_bits = bits_for(palette.size());
+    if (new_bits != bits) {
+      repack(new_bits);
+    }
+  }
+
+  if (bits == 0) {
+    return;
+  }
+  const size_t bit = index * bits;
+  uint64_t &word = words[bit >> 6];
+  word = (word & ~(index_mask() << (bit & 63))) | (static_cast<uint64_t>(palette_index) << (bit & 63));
+}
+
+void palette_storage::repack(const uint8_t new_bits) {
+  std::vector<uint64_t> new_words((count * new_bits + 63) / 64, 0);
+  for (size_t i = 0; i < count; i++) {
+    const uint64_t palette_index = bits == 0 ? 0 : (words[(i * bits) >> 6] >> ((i * bits) & 63)) & index_mask();
+    const size_t bit = i * new_bits;
+    new_words[bit >> 6] |= palette_index << (bit & 63);
+  }
+  words = std::move(new_words);
+  bits = new_bits;
+}
+
+void palette_storage::unpack(block_t *out) const noexcept {
+  if (bits == 0) {
+    std::fill_n(out, count, count > 0 ? palette[0] : block_type::air);
+    return;
+  }
+
+  const size_t per_word = 64 / bits;
+  const uint64_t mask = index_mask();
+  size_t i = 0;
+  for (const uint64_t word : words) {
+    const size_t end = std::min(count, i + per_word);
+    uint64_t value = word;
+    for (; i < end; i++) {
+      *out++ = palette[value & mask];
+      value >>= bits;
+    }
+  }
+}
+
+std::vector<Block> palette_storage::to_blocks() const {
+  std::vector<Block> blocks(count);
+  static_assert(sizeof(Block) == sizeof(block_t), "Blocks are written as bytes");
+  unpack(reinterpret_cast<block_t *>(blocks.data()));
+  return blocks;
+}
+
+void palette_storage::compact() {
+  if (count == 0 || palette.size() <= 1) {
+    return;
+  }
+  *this = palette_storage(to_blocks());
+  words.shrink_to_fit();
+}
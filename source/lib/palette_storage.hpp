@@ -0,0 +1,77 @@
+#ifndef WORLD_OF_CUBE_PALETTE_STORAGE_HPP
+#define WORLD_OF_CUBE_PALETTE_STORAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Cube lib
+#include "Block.hpp"
+#include "block_type.hpp"
+
+// Block storage of a chunk: local palette of the block types in use, and one bit-packed palette index per block.
+// Index width is 0 (single type), 1, 2, 4 or 8 bits depending on the palette size, so an index never crosses a word.
+// The palette grows on demand when a new block type is set, unused entries are only dropped by compact().
+class palette_storage {
+public:
+  using block_t = block_type::block_t;
+
+  palette_storage() = default;
+
+  palette_storage(size_t _count, block_t fill);
+
+  explicit palette_storage(const std::vector<Block> &blocks);
+
+  // Take an already packed palette and indices (e.g. read from disk), the index width comes from the palette size
+  palette_storage(std::vector<block_t> _palette, std::vector<uint64_t> _words, size_t _count);
+
+  // Size of the packed indices of count blocks with a palette of palette_size entries
+  [[nodiscard]] static size_t word_count(size_t _count, size_t palette_size) noexcept;
+
+  // Smallest index width able to address palette_size entries
+  [[nodiscard]] static uint8_t bits_for(size_t palette_size) noexcept;
+
+  [[nodiscard]] inline block_t get(const size_t index) const noexcept {
+    if (bits == 0) {
+      return palette[0];
+    }
+    const size_t bit = index * bits;
+    return palette[(words[bit >> 6] >> (bit & 63)) & index_mask()];
+  }
+
+  void set(size_t index, block_t type);
+
+  // Copy all block types in memory order to out (size() entries)
+  void unpack(block_t *out) const noexcept;
+
+  [[nodiscard]] std::vector<Block> to_blocks() const;
+
+  // Rebuild the palette with the block types still in use only
+  void compact();
+
+  [[nodiscard]] inline size_t size() const noexcept { return count; }
+
+  [[nodiscard]] inline bool empty() const noexcept { return count == 0; }
+
+  [[nodiscard]] inline uint8_t bits_per_block() const noexcept { return bits; }
+
+  [[nodiscard]] inline const std::vector<block_t> &get_palette() const noexcept { return palette; }
+
+  [[nodiscard]] inline const std::vector<uint64_t> &get_words() const noexcept { return words; }
+
+  // Heap memory used by the palette and the packed indices
+  [[nodiscard]] inline size_t memory_bytes() const noexcept { return palette.capacity() * sizeof(block_t) + words.capacity() * sizeof(uint64_t); }
+
+private:
+  [[nodiscard]] inline uint64_t index_mask() const noexcept { return (uint64_t{1} << bits) - 1; }
+
+  // Re-pack the indices with a new index width
+  void repack(uint8_t new_bits);
+
+  std::vector<block_t> palette;
+  std::vector<uint64_t> words;
+  size_t count = 0;
+  uint8_t bits = 0;
+};
+
+#endif // WORLD_OF_CUBE_PALETTE_STORAGE_HPP
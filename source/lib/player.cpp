@@ -68,6 +68,7 @@ void player::updateGameInput() {
   // Update player Chunk position in game context
   _game_context_ref.player_chunk_pos = std::move(Chunk::get_chunk_position(camera.position));
   _game_context_ref.player_pos = std::move(camera.position);
+  _game_context_ref.player_view_direction = {camera.target.x - camera.position.x, camera.target.y - camera.position.y, camera.target.z - camera.position.z};
 }
 
 void player::updateGameLogic() {}
@@ -0,0 +1,519 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <zlib.h>
+
+#include "region_file.hpp"
+
+static_assert(std::endian::native == std::endian::little, "Region files are written in the host byte order");
+
+namespace {
+[[nodiscard]] constexpr int32_t floor_div(const int32_t value, const int32_t divisor) noexcept {
+  return (value < 0 ? value - (divisor - 1) : value) / divisor;
+}
+
+[[nodiscard]] constexpr size_t align_up(const size_t value, const size_t alignment) noexcept { return (value + alignment - 1) / alignment * alignment; }
+
+constexpr size_t chunk_block_count = Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z;
+
+// Raw chunk encoding header
+struct blocks_header {
+  uint32_t count;
+  uint16_t palette_size;
+  uint16_t reserved;
+};
+static_assert(sizeof(blocks_header) == 8, "The palette starts 8 bytes aligned");
+
+constexpr size_t blocks_header_size = sizeof(blocks_header);
+
+[[nodiscard]] constexpr bool is_valid(const blocks_header &header) noexcept {
+  return header.count == chunk_block_count && header.palette_size != 0 && header.palette_size <= 256;
+}
+
+[[nodiscard]] constexpr size_t palette_bytes(const size_t palette_size) noexcept {
+  return align_up(palette_size * sizeof(palette_storage::block_t), sizeof(uint64_t));
+}
+
+// Sequential zlib decompression into caller buffers
+class inflate_stream {
+public:
+  inflate_stream(const uint8_t *data, const size_t size) {
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = static_cast<uInt>(size);
+    valid = inflateInit(&stream) == Z_OK;
+  }
+
+  inflate_stream(const inflate_stream &) = delete;
+  inflate_stream &operator=(const inflate_stream &) = delete;
+
+  ~inflate_stream() { inflateEnd(&stream); }
+
+  // Fill out with the next size bytes of the stream
+  bool read(void *out, const size_t size) {
+    stream.next_out = static_cast<Bytef *>(out);
+    stream.avail_out = static_cast<uInt>(size);
+    while (valid && stream.avail_out > 0) {
+      const int result = inflate(&stream, Z_NO_FLUSH);
+      ended = result == Z_STREAM_END;
+      valid = result == Z_OK || (ended && stream.avail_out == 0);
+    }
+    return valid;
+  }
+
+  // The whole stream was read, nothing left
+  bool finish() {
+    if (valid && !ended) {
+      uint8_t extra = 0;
+      stream.next_out = &extra;
+      stream.avail_out = 1;
+      ended = inflate(&stream, Z_NO_FLUSH) == Z_STREAM_END && stream.avail_out == 1;
+    }
+    return valid && ended;
+  }
+
+private:
+  z_stream stream = {};
+  bool valid = false;
+  bool ended = false;
+};
+} // namespace
+
+palette_storage chunk_view::to_storage() const {
+  return palette_storage(std::vector<block_t>(palette, palette + palette_size), std::vector<uint64_t>(words, words + palette_storage::word_count(count, palette_size)),
+                         count);
+}
+
+region_file::region_file(std::filesystem::path _path, const region_read_mode _read_mode) : path(std::move(_path)), read_mode(_read_mode) {
+  if (!std::filesystem::exists(path)) {
+    return;
+  }
+  file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+
+  uint32_t header[4] = {};
+  file.read(reinterpret_cast<char *>(header), sizeof(header));
+  file.read(reinterpret_cast<char *>(table.data()), sizeof(table));
+  // Unknown or truncated file: treated as empty, rewritten on the first write
+  if (!file || header[0] != magic || header[1] != version || header[2] != region_size) {
+    file.close();
+    table = {};
+    return;
+  }
+
+  file_end = data_offset;
+  for (const auto &current : table) {
+    if (current.offset != 0) {
+      file_end = std::max(file_end, align_up(current.offset + current.size, payload_alignment));
+    }
+  }
+}
+
+void region_file::create() {
+  table = {};
+  {
+    std::ofstream new_file(path, std::ios::binary | std::ios::trunc);
+    const uint32_t header[4] = {magic, version, region_size, 0};
+    new_file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    new_file.write(reinterpret_cast<const char *>(table.data()), sizeof(table));
+  }
+  file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+  file_end = data_offset;
+}
+
+bool region_file::contains(const benlib::Vector3i &chunk_pos) const noexcept { return table[chunk_index(chunk_pos)].offset != 0; }
+
+std::unique_ptr<Chunk> region_file::read_chunk(const benlib::Vector3i &chunk_pos, const chunk_baseline_fn &baseline) {
+  const entry &current = table[chunk_index(chunk_pos)];
+  if (current.offset == 0 || !file.is_open() || (current.kind == payload_kind::delta && baseline == nullptr)) {
+    return nullptr;
+  }
+
+  // Payload straight from the mapping, or read in a buffer
+  std::vector<uint8_t> buffer;
+  const uint8_t *payload = read_mode == region_read_mode::mmap ? mapped_payload(current) : nullptr;
+  if (payload == nullptr) {
+    buffer.resize(current.size);
+    file.clear();
+    file.seekg(current.offset);
+    file.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    if (!file) {
+      return nullptr;
+    }
+    payload = buffer.data();
+  }
+
+  if (current.kind == payload_kind::delta) {
+    // Deltas are small, inflated in a buffer
+    std::vector<uint8_t> raw;
+    if (current.compression_type == compression::zlib) {
+      raw.resize(current.raw_size);
+      uLongf raw_size = static_cast<uLongf>(raw.size());
+      if (uncompress(raw.data(), &raw_size, payload, static_cast<uLong>(current.size)) != Z_OK || raw_size != raw.size()) {
+        return nullptr;
+      }
+      payload = raw.data();
+    }
+    std::unique_ptr<Chunk> delta_chunk = baseline(chunk_pos);
+    if (delta_chunk == nullptr || !apply_delta(payload, current.raw_size, *delta_chunk)) {
+      return nullptr;
+    }
+    return delta_chunk;
+  }
+
+  palette_storage blocks;
+  const bool valid = current.compression_type == compression::zlib ? inflate_blocks(payload, current.size, blocks) : decode_blocks(payload, current.size, blocks);
+  if (!valid) {
+    return nullptr;
+  }
+  return std::make_unique<Chunk>(std::move(blocks), chunk_pos.x, chunk_pos.y, chunk_pos.z);
+}
+
+bool region_file::view_chunk(const benlib::Vector3i &chunk_pos, chunk_view &view) {
+  const entry &current = table[chunk_index(chunk_pos)];
+  if (current.offset == 0 || current.compression_type != compression::none || current.kind != payload_kind::full || read_mode != region_read_mode::mmap) {
+    return false;
+  }
+  const uint8_t *payload = mapped_payload(current);
+  return payload != nullptr && view_blocks(payload, current.size, view);
+}
+
+const uint8_t *region_file::mapped_payload(const entry &current) {
+  // Appended payloads are only visible in a new mapping
+  if (mapping.size() < current.offset + current.size && !mapping.map(path)) {
+    return nullptr;
+  }
+  if (mapping.size() < current.offset + current.size) {
+    return nullptr;
+  }
+  return mapping.data() + current.offset;
+}
+
+size_t region_file::write_chunks(const std::vector<const Chunk *> &chunks, const int compression_level) {
+  std::vector<chunk_payload> payloads;
+  payloads.reserve(chunks.size());
+  for (const Chunk *current_chunk : chunks) {
+    payloads.push_back({current_chunk->get_position(), payload_kind::full, encode_blocks(current_chunk->get_storage())});
+  }
+  return write_payloads(payloads, compression_level);
+}
+
+size_t region_file::write_payloads(const std::vector<chunk_payload> &payloads, const int compression_level) {
+  if (payloads.empty()) {
+    return 0;
+  }
+  if (!file.is_open()) {
+    create();
+  }
+  file.clear();
+
+  static constexpr char padding[payload_alignment] = {};
+  size_t written = sizeof(table);
+  std::vector<uint8_t> compressed;
+  for (const auto &current_payload : payloads) {
+    const std::vector<uint8_t> *data = &current_payload.data;
+    compression compression_type = compression::none;
+    if (compression_level > 0) {
+      compressed.resize(compressBound(static_cast<uLong>(data->size())));
+      uLongf compressed_size = static_cast<uLongf>(compressed.size());
+      // Tiny payloads (uniform chunks, few edits) may not shrink, they stay raw
+      if (compress2(compressed.data(), &compressed_size, data->data(), static_cast<uLong>(data->size()), compression_level) == Z_OK &&
+          compressed_size < data->size()) {
+        compressed.resize(compressed_size);
+        data = &compressed;
+        compression_type = compression::zlib;
+      }
+    }
+
+    entry &current = table[chunk_index(current_payload.pos)];
+    const size_t slot_size = align_up(data->size(), payload_alignment);
+    size_t offset = current.offset;
+    if (offset == 0 || slot_size > align_up(current.size, payload_alignment)) {
+      offset = file_end;
+      file_end += slot_size;
+    }
+
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char *>(data->data()), static_cast<std::streamsize>(data->size()));
+    file.write(padding, static_cast<std::streamsize>(slot_size - data->size()));
+    current = {static_cast<uint32_t>(offset),
+               static_cast<uint32_t>(data->size()),
+               static_cast<uint32_t>(current_payload.data.size()),
+               compression_type,
+               current_payload.kind,
+               {}};
+    written += slot_size;
+  }
+
+  file.seekp(header_size);
+  file.write(reinterpret_cast<const char *>(table.data()), sizeof(table));
+  file.flush();
+  return written;
+}
+
+size_t region_file::payload_size(const benlib::Vector3i &chunk_pos) const noexcept {
+  const entry &current = table[chunk_index(chunk_pos)];
+  return current.offset == 0 ? 0 : current.size;
+}
+
+benlib::Vector3i region_file::region_position(const benlib::Vector3i &chunk_pos) noexcept {
+  return {floor_div(chunk_pos.x, region_size), floor_div(chunk_pos.y, region_size), floor_div(chunk_pos.z, region_size)};
+}
+
+size_t region_file::chunk_index(const benlib::Vector3i &chunk_pos) noexcept {
+  const benlib::Vector3i region_pos = region_position(chunk_pos);
+  return math::convert_to_1d<size_t>(static_cast<size_t>(chunk_pos.x - region_pos.x * region_size), static_cast<size_t>(chunk_pos.y - region_pos.y * region_size),
+                                     static_cast<size_t>(chunk_pos.z - region_pos.z * region_size), region_size, region_size, region_size);
+}
+
+std::vector<uint8_t> region_file::encode_blocks(const palette_storage &blocks) {
+  const auto &palette = blocks.get_palette();
+  const auto &words = blocks.get_words();
+
+  std::vector<uint8_t> data(blocks_header_size + palette_bytes(palette.size()) + words.size() * sizeof(uint64_t), 0);
+  const blocks_header header = {static_cast<uint32_t>(blocks.size()), static_cast<uint16_t>(palette.size()), 0};
+  std::memcpy(data.data(), &header, sizeof(header));
+  std::memcpy(data.data() + blocks_header_size, palette.data(), palette.size() * sizeof(palette_storage::block_t));
+  std::memcpy(data.data() + blocks_header_size + palette_bytes(palette.size()), words.data(), words.size() * sizeof(uint64_t));
+  return data;
+}
+
+bool region_file::decode_blocks(const uint8_t *data, const size_t size, palette_storage &blocks) {
+  chunk_view view;
+  if (!view_blocks(data, size, view)) {
+    return false;
+  }
+  blocks = view.to_storage();
+  return true;
+}
+
+bool region_file::inflate_blocks(const uint8_t *data, const size_t size, palette_storage &blocks) {
+  inflate_stream stream(data, size);
+  blocks_header header = {};
+  if (!stream.read(&header, sizeof(header)) || !is_valid(header)) {
+    return false;
+  }
+
+  std::vector<palette_storage::block_t> palette(palette_bytes(header.palette_size));
+  std::vector<uint64_t> words(palette_storage::word_count(header.count, header.palette_size));
+  if (!stream.read(palette.data(), palette.size()) || !stream.read(words.data(), words.size() * sizeof(uint64_t)) || !stream.finish()) {
+    return false;
+  }
+  palette.resize(header.palette_size);
+  blocks = palette_storage(std::move(palette), std::move(words), header.count);
+  return true;
+}
+
+bool region_file::view_blocks(const uint8_t *data, const size_t size, chunk_view &view) {
+  if (size < blocks_header_size) {
+    return false;
+  }
+  blocks_header header = {};
+  std::memcpy(&header, data, sizeof(header));
+  if (!is_valid(header)) {
+    return false;
+  }
+
+  const size_t word_count = palette_storage::word_count(header.count, header.palette_size);
+  if (size != blocks_header_size + palette_bytes(header.palette_size) + word_count * sizeof(uint64_t)) {
+    return false;
+  }
+
+  view.palette = reinterpret_cast<const palette_storage::block_t *>(data + blocks_header_size);
+  view.words = reinterpret_cast<const uint64_t *>(data + blocks_header_size + palette_bytes(header.palette_size));
+  view.palette_size = header.palette_size;
+  view.count = header.count;
+  view.bits = palette_storage::bits_for(header.palette_size);
+  return true;
+}
+
+std::vector<uint8_t> region_file::encode_delta(const Chunk &chunk, const Chunk &baseline) {
+  std::vector<palette_storage::block_t> blocks(chunk.size());
+  std::vector<palette_storage::block_t> baseline_blocks(baseline.size());
+  chunk.get_storage().unpack(blocks.data());
+  baseline.get_storage().unpack(baseline_blocks.data());
+
+  std::vector<uint16_t> indices;
+  std::vector<palette_storage::block_t> types;
+  for (size_t i = 0; i < blocks.size() && i < baseline_blocks.size(); i++) {
+    if (blocks[i] != baseline_blocks[i]) {
+      indices.push_back(static_cast<uint16_t>(i));
+      types.push_back(blocks[i]);
+    }
+  }
+
+  // Indices then types, runs of close indices and same types compress well
+  const uint32_t count = static_cast<uint32_t>(indices.size());
+  std::vector<uint8_t> data(sizeof(count) + indices.size() * sizeof(uint16_t) + types.size() * sizeof(palette_storage::block_t));
+  std::memcpy(data.data(), &count, sizeof(count));
+  std::memcpy(data.data() + sizeof(count), indices.data(), indices.size() * sizeof(uint16_t));
+  std::memcpy(data.data() + sizeof(count) + indices.size() * sizeof(uint16_t), types.data(), types.size() * sizeof(palette_storage::block_t));
+  return data;
+}
+
+bool region_file::apply_delta(const uint8_t *data, const size_t size, Chunk &chunk) {
+  uint32_t count = 0;
+  if (size < sizeof(count)) {
+    return false;
+  }
+  std::memcpy(&count, data, sizeof(count));
+  if (count > chunk_block_count || size != sizeof(count) + count * (sizeof(uint16_t) + sizeof(palette_storage::block_t))) {
+    return false;
+  }
+
+  const uint8_t *types = data + sizeof(count) + count * sizeof(uint16_t);
+  for (uint32_t i = 0; i < count; i++) {
+    uint16_t index = 0;
+    std::memcpy(&index, data + sizeof(count) + i * sizeof(uint16_t), sizeof(index));
+    if (index >= chunk_block_count) {
+      return false;
+    }
+    const int x = index % Chunk::chunk_size_x;
+    const int y = (index / Chunk::chunk_size_x) % Chunk::chunk_size_y;
+    const int z = index / (Chunk::chunk_size_x * Chunk::chunk_size_y);
+    chunk.set_block(x, y, z, Block(types[i]));
+  }
+  return true;
+}
+
+region_storage::region_storage(std::filesystem::path _directory, const int _compression_level, const region_read_mode _read_mode)
+    : directory(std::move(_directory)), compression_level(_compression_level), read_mode(_read_mode) {
+  std::filesystem::create_directories(directory);
+}
+
+region_save_mode region_storage::save_mode_from_string(const std::string &name) noexcept {
+  return name == "delta" ? region_save_mode::delta : region_save_mode::full;
+}
+
+void region_storage::set_save_mode(const region_save_mode _save_mode, chunk_baseline_fn _baseline) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  save_mode = _baseline != nullptr ? _save_mode : region_save_mode::full;
+  baseline = std::move(_baseline);
+}
+
+bool region_storage::needs_save(const Chunk &chunk) const noexcept {
+  return !chunk.is_saved() && (save_mode == region_save_mode::full || chunk.is_edited());
+}
+
+region_read_mode region_storage::read_mode_from_string(const std::string &name) noexcept {
+  if (name == "mmap" && mapped_file::is_supported()) {
+    return region_read_mode::mmap;
+  }
+  return region_read_mode::buffered;
+}
+
+std::filesystem::path region_storage::region_path(const benlib::Vector3i &region_pos) const {
+  return directory / ("r." + std::to_string(region_pos.x) + "." + std::to_string(region_pos.y) + "." + std::to_string(region_pos.z) + ".wocr");
+}
+
+region_file &region_storage::open_region(const benlib::Vector3i &region_pos) {
+  const chunk_registry::key_t key = chunk_registry::pack(region_pos);
+  auto it = regions.find(key);
+  if (it != regions.end()) {
+    return *it->second;
+  }
+  if (regions.size() >= max_open_regions) {
+    regions.clear();
+  }
+  return *regions.emplace(key, std::make_unique<region_file>(region_path(region_pos), read_mode)).first->second;
+}
+
+bool region_storage::contains(const benlib::Vector3i &chunk_pos) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return open_region(region_file::region_position(chunk_pos)).contains(chunk_pos);
+}
+
+std::unique_ptr<Chunk> region_storage::load_chunk(const benlib::Vector3i &chunk_pos) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::unique_ptr<Chunk> loaded_chunk = open_region(region_file::region_position(chunk_pos)).read_chunk(chunk_pos, baseline);
+  if (loaded_chunk != nullptr) {
+    loaded_chunk->set_saved(true);
+    loaded_chunks++;
+  }
+  return loaded_chunk;
+}
+
+std::vector<std::unique_ptr<Chunk>> region_storage::load_chunks(const std::vector<benlib::Vector3i> &positions) {
+  std::vector<std::unique_ptr<Chunk>> loaded(positions.size());
+  for (size_t i = 0; i < positions.size(); i++) {
+    loaded[i] = load_chunk(positions[i]);
+  }
+  return loaded;
+}
+
+void region_storage::save_chunk(const Chunk &chunk) { save_chunks(std::vector<const Chunk *>{&chunk}); }
+
+void region_storage::save_chunks(const std::vector<std::unique_ptr<Chunk>> &chunks) {
+  std::vector<const Chunk *> chunk_pointers;
+  chunk_pointers.reserve(chunks.size());
+  for (const auto &current_chunk : chunks) {
+    if (current_chunk != nullptr) {
+      chunk_pointers.push_back(current_chunk.get());
+    }
+  }
+  save_chunks(chunk_pointers);
+}
+
+void region_storage::save_chunks(const std::vector<const Chunk *> &chunks) {
+  // Group by region
+  std::vector<std::pair<chunk_registry::key_t, const Chunk *>> sorted;
+  sorted.reserve(chunks.size());
+  for (const Chunk *current_chunk : chunks) {
+    sorted.push_back({chunk_registry::pack(region_file::region_position(current_chunk->get_position())), current_chunk});
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<const Chunk *> region_chunks;
+  for (size_t begin = 0; begin < sorted.size();) {
+    size_t end = begin;
+    region_chunks.clear();
+    for (; end < sorted.size() && sorted[end].first == sorted[begin].first; end++) {
+      region_chunks.push_back(sorted[end].second);
+    }
+
+    region_file &region = open_region(region_file::region_position(sorted[begin].second->get_position()));
+    if (save_mode == region_save_mode::delta) {
+      std::vector<region_file::chunk_payload> payloads;
+      payloads.reserve(region_chunks.size());
+      for (const Chunk *current_chunk : region_chunks) {
+        const benlib::Vector3i pos = current_chunk->get_position();
+        const std::unique_ptr<Chunk> baseline_chunk = baseline(pos);
+        if (baseline_chunk == nullptr) {
+          payloads.push_back({pos, region_file::payload_kind::full, region_file::encode_blocks(current_chunk->get_storage())});
+          continue;
+        }
+        payloads.push_back({pos, region_file::payload_kind::delta, region_file::encode_delta(*current_chunk, *baseline_chunk)});
+      }
+      bytes_written += region.write_payloads(payloads, compression_level);
+    } else {
+      bytes_written += region.write_chunks(region_chunks, compression_level);
+    }
+    for (const Chunk *current_chunk : region_chunks) {
+      payload_bytes += region.payload_size(current_chunk->get_position());
+    }
+    saved_chunks += region_chunks.size();
+    begin = end;
+  }
+}
+
+uint64_t region_storage::get_loaded_chunks() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return loaded_chunks;
+}
+
+uint64_t region_storage::get_saved_chunks() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return saved_chunks;
+}
+
+uint64_t region_storage::get_bytes_written() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return bytes_written;
+}
+
+uint64_t region_storage::get_payload_bytes() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return payload_bytes;
+}
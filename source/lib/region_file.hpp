@@ -0,0 +1,254 @@
+#ifndef WORLD_OF_CUBE_REGION_FILE_HPP
+#define WORLD_OF_CUBE_REGION_FILE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Cube lib
+#include "Chunk.hpp"
+#include "chunk_registry.hpp"
+#include "mapped_file.hpp"
+#include "palette_storage.hpp"
+#include "vector.hpp"
+
+// How region files are read
+enum class region_read_mode : uint8_t {
+  // Payloads are read through the file stream into a buffer
+  buffered = 0,
+  // Payloads are read from a read only mapping of the file, no intermediate buffer (buffered if mapping is not supported)
+  mmap = 1,
+};
+
+// What region_storage writes for a chunk
+enum class region_save_mode : uint8_t {
+  // Every block (palette and packed indices)
+  full = 0,
+  // Only the blocks that differ from the chunk regenerated from the seed, only edited chunks are saved
+  delta = 1,
+};
+
+// Chunk regenerated from the seed, the reference of delta payloads
+using chunk_baseline_fn = std::function<std::unique_ptr<Chunk>(const benlib::Vector3i &)>;
+
+// Read only view of a raw chunk payload in the mapping of a region_file. Only valid until the next read_chunk, view_chunk or write
+// on that region_file: a read past the mapped end maps the file again (the old mapping is unmapped), a write may rewrite the payload
+// in place. Also invalid once the region_file is destroyed, region_storage closes all its regions when max_open_regions are open,
+// so views are only taken on a region_file owned by the caller. Copy the blocks (to_storage) to keep them
+struct chunk_view {
+  using block_t = palette_storage::block_t;
+
+  const block_t *palette = nullptr;
+  const uint64_t *words = nullptr;
+  size_t palette_size = 0;
+  size_t count = 0;
+  uint8_t bits = 0;
+
+  [[nodiscard]] inline block_t get(const size_t index) const noexcept {
+    if (bits == 0) {
+      return palette[0];
+    }
+    const size_t bit = index * bits;
+    return palette[(words[bit >> 6] >> (bit & 63)) & ((uint64_t{1} << bits) - 1)];
+  }
+
+  // Owning copy of the blocks
+  [[nodiscard]] palette_storage to_storage() const;
+};
+
+// On disk block of region_size^3 chunks.
+//
+// File layout (little endian):
+//   header     magic "WOCR", format version, region size, reserved (4 x uint32)
+//   table      chunk_count entries, chunk index z * 16 * 16 + y * 16 + x, offset 0: chunk not saved
+//   payloads   one per saved chunk, 8 bytes aligned, zlib stream or raw encoding
+//
+// Raw chunk encoding: block count (uint32), palette size (uint16), reserved (uint16), palette padded to 8 bytes,
+// then the packed palette indices as in palette_storage (uint64 words).
+// Raw delta encoding: edit count (uint32), then the ascending block indices (uint16 each) and the block types of the edits.
+//
+// A chunk saved again is written in place if it fits in its old slot, appended otherwise.
+// In mmap read mode the file is mapped on the first read and mapped again when a payload is past the mapped end (the file grew).
+// Not thread safe, see region_storage.
+class region_file {
+public:
+  static constexpr int32_t region_size = 16;
+  static constexpr size_t chunk_count = region_size * region_size * region_size;
+  static constexpr uint32_t magic = 0x52434f57; // "WOCR"
+  static constexpr uint32_t version = 1;
+
+  enum class compression : uint8_t {
+    none = 0,
+    zlib = 1,
+  };
+
+  enum class payload_kind : uint8_t {
+    // Raw chunk encoding
+    full = 0,
+    // Raw delta encoding, applied to the regenerated chunk
+    delta = 1,
+  };
+
+  // Raw encoding of a chunk, compressed when written
+  struct chunk_payload {
+    benlib::Vector3i pos;
+    payload_kind kind;
+    std::vector<uint8_t> data;
+  };
+
+  struct entry {
+    // Payload position in the file, 0: chunk not saved
+    uint32_t offset;
+    // Payload bytes in the file
+    uint32_t size;
+    // Raw chunk encoding bytes
+    uint32_t raw_size;
+    compression compression_type;
+    payload_kind kind;
+    uint8_t reserved[2];
+  };
+  static_assert(sizeof(entry) == 16, "Table entries are written as bytes");
+
+  static constexpr size_t header_size = 4 * sizeof(uint32_t);
+  static constexpr size_t data_offset = header_size + chunk_count * sizeof(entry);
+  static constexpr size_t payload_alignment = 8;
+
+  // Open the region file if it exists, it is created on the first write
+  explicit region_file(std::filesystem::path _path, region_read_mode _read_mode = region_read_mode::buffered);
+
+  region_file(const region_file &) = delete;
+  region_file &operator=(const region_file &) = delete;
+
+  [[nodiscard]] bool contains(const benlib::Vector3i &chunk_pos) const noexcept;
+
+  // nullptr if the chunk is not saved or its payload is invalid. Delta payloads are applied to the chunk from baseline,
+  // nullptr without baseline
+  [[nodiscard]] std::unique_ptr<Chunk> read_chunk(const benlib::Vector3i &chunk_pos, const chunk_baseline_fn &baseline = nullptr);
+
+  // View the blocks of a chunk saved without compression in the mapped file, false if not saved, compressed or not mapped.
+  // May map the file again, which invalidates the views taken before (see chunk_view)
+  [[nodiscard]] bool view_chunk(const benlib::Vector3i &chunk_pos, chunk_view &view);
+
+  // Write the chunks (all in this region) and the table once, compression_level: zlib level, 0: no compression.
+  // Return the bytes written
+  size_t write_chunks(const std::vector<const Chunk *> &chunks, int compression_level);
+
+  size_t write_payloads(const std::vector<chunk_payload> &payloads, int compression_level);
+
+  // Payload bytes of the chunk in the file, 0 if not saved
+  [[nodiscard]] size_t payload_size(const benlib::Vector3i &chunk_pos) const noexcept;
+
+  [[nodiscard]] const std::filesystem::path &get_path() const noexcept { return path; }
+
+  // Bytes of the file, 0 if not created yet
+  [[nodiscard]] size_t file_size() const noexcept { return file_end; }
+
+  // Region containing the chunk
+  [[nodiscard]] static benlib::Vector3i region_position(const benlib::Vector3i &chunk_pos) noexcept;
+
+  // Index of the chunk in its region table
+  [[nodiscard]] static size_t chunk_index(const benlib::Vector3i &chunk_pos) noexcept;
+
+  [[nodiscard]] static std::vector<uint8_t> encode_blocks(const palette_storage &blocks);
+
+  // Return false if the encoding is invalid for a chunk
+  [[nodiscard]] static bool decode_blocks(const uint8_t *data, size_t size, palette_storage &blocks);
+
+  // Decompress a zlib payload straight into the palette and the indices, return false if invalid
+  [[nodiscard]] static bool inflate_blocks(const uint8_t *data, size_t size, palette_storage &blocks);
+
+  [[nodiscard]] static bool view_blocks(const uint8_t *data, size_t size, chunk_view &view);
+
+  // Blocks of chunk that differ from baseline
+  [[nodiscard]] static std::vector<uint8_t> encode_delta(const Chunk &chunk, const Chunk &baseline);
+
+  // Set the blocks of a raw delta in chunk, return false if the encoding is invalid
+  [[nodiscard]] static bool apply_delta(const uint8_t *data, size_t size, Chunk &chunk);
+
+private:
+  // Create the file with an empty table
+  void create();
+
+  // Payload of the entry in the mapping, nullptr if the file cannot be mapped
+  [[nodiscard]] const uint8_t *mapped_payload(const entry &current);
+
+  std::filesystem::path path;
+  region_read_mode read_mode;
+  std::fstream file;
+  mapped_file mapping;
+  std::array<entry, chunk_count> table = {};
+  size_t file_end = 0;
+};
+
+// Directory of region files (one per 16^3 chunks, r.<x>.<y>.<z>.wocr), keeps the last used regions open.
+// Thread safe, one lock for all regions.
+class region_storage {
+public:
+  explicit region_storage(std::filesystem::path _directory, int _compression_level = 1, region_read_mode _read_mode = region_read_mode::mmap);
+
+  [[nodiscard]] static region_read_mode read_mode_from_string(const std::string &name) noexcept;
+
+  [[nodiscard]] static region_save_mode save_mode_from_string(const std::string &name) noexcept;
+
+  // Delta mode needs the baseline to build and to load delta payloads, full mode still loads the delta payloads with it
+  void set_save_mode(region_save_mode _save_mode, chunk_baseline_fn _baseline = nullptr);
+
+  [[nodiscard]] region_save_mode get_save_mode() const noexcept { return save_mode; }
+
+  // The chunk has something to write: not saved since its last change (full), edited and not saved (delta)
+  [[nodiscard]] bool needs_save(const Chunk &chunk) const noexcept;
+
+  [[nodiscard]] bool contains(const benlib::Vector3i &chunk_pos);
+
+  // nullptr if the chunk is not saved, loaded chunks are flagged as saved
+  [[nodiscard]] std::unique_ptr<Chunk> load_chunk(const benlib::Vector3i &chunk_pos);
+
+  // Same order as positions, nullptr for the chunks not saved
+  [[nodiscard]] std::vector<std::unique_ptr<Chunk>> load_chunks(const std::vector<benlib::Vector3i> &positions);
+
+  void save_chunk(const Chunk &chunk);
+
+  // Grouped by region, each region table is written once
+  void save_chunks(const std::vector<const Chunk *> &chunks);
+
+  void save_chunks(const std::vector<std::unique_ptr<Chunk>> &chunks);
+
+  [[nodiscard]] const std::filesystem::path &get_directory() const noexcept { return directory; }
+
+  [[nodiscard]] std::filesystem::path region_path(const benlib::Vector3i &region_pos) const;
+
+  [[nodiscard]] uint64_t get_loaded_chunks();
+  [[nodiscard]] uint64_t get_saved_chunks();
+  // Payload and table bytes written since the storage was opened
+  [[nodiscard]] uint64_t get_bytes_written();
+  // Payload bytes written (without table and padding) since the storage was opened
+  [[nodiscard]] uint64_t get_payload_bytes();
+
+private:
+  region_file &open_region(const benlib::Vector3i &region_pos);
+
+  // Open files kept, all are closed when reached
+  static constexpr size_t max_open_regions = 64;
+
+  std::filesystem::path directory;
+  int compression_level;
+  region_read_mode read_mode;
+  region_save_mode save_mode = region_save_mode::full;
+  chunk_baseline_fn baseline;
+  std::mutex _mutex;
+  std::unordered_map<chunk_registry::key_t, std::unique_ptr<region_file>> regions;
+  uint64_t loaded_chunks = 0;
+  uint64_t saved_chunks = 0;
+  uint64_t bytes_written = 0;
+  uint64_t payload_bytes = 0;
+};
+
+#endif // WORLD_OF_CUBE_REGION_FILE_HPP
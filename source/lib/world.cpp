@@ -5,6 +5,36 @@ world::world(gameContext &game_context_ref, nlohmann::json &_config_json) : _gam
 
   render_distance = _configJson["world"].value("render_distance", 4);
   view_distance = _configJson["world"].value("view_distance", 8);
+  generation_queue.set_view_bias(_configJson["world"].value("view_direction_bias", 0.5f));
+  generation_batch_size = _configJson["world"].value("generation_batch_size", 8);
+  region_batch_radius = _configJson["world"].value("region_batch_radius", 2);
+  upload_budget_ms = _configJson["world"].value("upload_budget_ms", 2.0);
+  world_md.mesher = world_model::mesher_from_string(_configJson["world"].value("mesher", std::string("bitmask")));
+  world_md.indexed_meshes = _configJson["world"].value("indexed_meshes", true);
+  upload_budget_bytes = _configJson["world"].value("upload_budget_bytes", static_cast<size_t>(8 * 1024 * 1024));
+
+  genv2.set_classifier_samples(_configJson["world"].value("classifier_samples", 4u));
+  genv2.set_sea_level(_configJson["world"].value("sea_level", 0));
+  genv2.set_caves(_configJson["world"].value("caves", true));
+  genv2.set_decoration(_configJson["world"].value("decoration", true));
+  genv2.set_tree_rarity(_configJson["world"].value("tree_rarity", 61u));
+  genv2.set_column_cache_capacity(_configJson["world"].value("column_cache_capacity", static_cast<size_t>(1024)));
+  if (!genv2.set_noise_lattice(_configJson["world"].value("noise_lattice_xz", 1u), _configJson["world"].value("noise_lattice_y", 1u))) {
+    logger->warn("Noise lattice steps must divide the chunk size, using {} {}", genv2.get_noise_lattice_xz(), genv2.get_noise_lattice_y());
+  }
+
+  save_chunks = _configJson["world"].value("save_chunks", true);
+  save_directory = _configJson["world"].value("save_directory", std::string("saves"));
+  region_compression_level = _configJson["world"].value("region_compression_level", 1);
+  region_read = region_storage::read_mode_from_string(_configJson["world"].value("region_read_mode", std::string("mmap")));
+  region_save = region_storage::save_mode_from_string(_configJson["world"].value("region_save_mode", std::string("full")));
+  io_write_delay = std::chrono::milliseconds(_configJson["world"].value("io_write_delay_ms", 100));
+  storage_seed = chunks_seed = genv2.get_seed();
+  storage_io = open_storage(std::make_shared<Generator>(genv2));
+
+  batch_generator = std::make_unique<Generator>(genv2);
+  generation_pool = std::make_unique<GeneratorPool>(genv2, _configJson["world"].value("generation_threads", 0u));
+  logger->info("Chunk generation pool started with {} threads", generation_pool->get_thread_count());
 
   generate_world_thread = std::thread(&world::generate_world_thread_func, this);
   generate_world_thread_running = true;
@@ -19,6 +49,8 @@ world::~world() {
   std::lock_guard<std::mutex> lock(_mutex);
 
   clear();
+  // Wait for the pending writes
+  storage_io = nullptr;
 }
 
 std::unique_ptr<Chunk> world::generateChunk(const int32_t x, const int32_t y, const int32_t z, bool generate_model) {
@@ -41,7 +73,7 @@ std::unique_ptr<Chunk> world::generateChunk(const int32_t x, const int32_t y, co
 void world::generate_chunk_models(Chunk &chunk_new) {
   auto start = std::chrono::high_resolution_clock::now();
   std::unique_ptr<Model> chunk_model = world_md.generate_chunk_model(chunk_new);
-  chunk_model->materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = _game_context_ref._texture;
+  chunk_model->materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = chunk_texture();
 
   chunk_new.set_model(std::move(chunk_model));
 
@@ -52,27 +84,230 @@ void world::generate_chunk_models(Chunk &chunk_new) {
                 duration.count());
 }
 
-bool world::is_chunk_exist(std::list<std::unique_ptr<Chunk>> &_chunks, const int32_t x, const int32_t y, const int32_t z) const noexcept {
-  auto it = std::find_if(_chunks.begin(), _chunks.end(), [&](const auto &Chunk) {
-    auto chunk_pos = Chunk->get_position();
-    return chunk_pos.x == x && chunk_pos.y == y && chunk_pos.z == z;
+void world::generate_chunk_meshes(std::vector<std::unique_ptr<Chunk>> &_chunks) {
+  const bool use_neighbours = world_md.mesher == mesher_type::bitmask;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  generation_pool->parallel_for(_chunks.size(), [&](size_t i) {
+    Chunk &current_chunk = *_chunks[i];
+    current_chunk.set_occupancy(chunk_occupancy::make_shared(current_chunk));
+
+    // With the bitmask mesher, meshes are built once neighbours are known (see collect_chunk_mesh_jobs).
+    // Without neighbours, uniform chunks have no visible face (all air, or all blocks buried)
+    if (!use_neighbours && !current_chunk.is_uniform()) {
+      current_chunk.set_mesh(std::make_unique<Mesh>(world_md.build_chunk_mesh(current_chunk)));
+    }
+  });
+  auto end = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+  logger->trace("Meshing of {} chunks took {}ms", _chunks.size(), duration.count());
+}
+
+std::vector<chunk_mesh_job> world::collect_chunk_mesh_jobs(const std::vector<benlib::Vector3i> &new_positions) {
+  static constexpr benlib::Vector3i face_offsets[6] = {{0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}};
+
+  std::vector<chunk_mesh_job> jobs;
+  if (world_md.mesher != mesher_type::bitmask) {
+    return jobs;
+  }
+
+  // New chunks and their loaded neighbours, each once
+  std::vector<chunk_registry::key_t> keys;
+  std::vector<benlib::Vector3i> positions;
+  const auto add_position = [&](const benlib::Vector3i &pos) {
+    const chunk_registry::key_t key = chunk_registry::pack(pos);
+    if (std::find(keys.begin(), keys.end(), key) == keys.end() && chunks.contains(pos)) {
+      keys.push_back(key);
+      positions.push_back(pos);
+    }
+  };
+
+  for (const auto &pos : new_positions) {
+    // All air chunks never have faces
+    const Chunk *new_chunk = chunks.find(pos);
+    if (new_chunk != nullptr && new_chunk->is_uniform() && new_chunk->get_uniform_block().block_type == block_type::air) {
+      continue;
+    }
+    add_position(pos);
+  }
+  for (const auto &pos : new_positions) {
+    for (const auto &offset : face_offsets) {
+      add_position({pos.x + offset.x, pos.y + offset.y, pos.z + offset.z});
+    }
+  }
+
+  jobs.reserve(positions.size());
+  for (const auto &pos : positions) {
+    chunk_mesh_job job;
+    job.pos = pos;
+    job.occupancy = chunks.find(pos)->get_occupancy();
+    for (size_t face = 0; face < 6; face++) {
+      const Chunk *neighbour = chunks.find(pos.x + face_offsets[face].x, pos.y + face_offsets[face].y, pos.z + face_offsets[face].z);
+      job.neighbours[face] = neighbour != nullptr ? neighbour->get_occupancy() : nullptr;
+    }
+    // Full chunk buried in full chunks: no face, now and before
+    const auto &full = chunk_occupancy::uniform(true);
+    if (job.occupancy == full && std::all_of(job.neighbours.begin(), job.neighbours.end(), [&](const auto &neighbour) { return neighbour == full; })) {
+      continue;
+    }
+    if (job.occupancy != nullptr) {
+      jobs.push_back(std::move(job));
+    }
+  }
+  return jobs;
+}
+
+void world::run_chunk_mesh_jobs(std::vector<chunk_mesh_job> &jobs) {
+  std::vector<Mesh> meshes(jobs.size());
+
+  auto start = std::chrono::high_resolution_clock::now();
+  generation_pool->parallel_for(jobs.size(), [&](size_t i) {
+    const chunk_occupancy *neighbours[6];
+    for (size_t face = 0; face < 6; face++) {
+      neighbours[face] = jobs[i].neighbours[face].get();
+    }
+    meshes[i] = world_md.generate_chunk_mesh_bitmask(*jobs[i].occupancy, neighbours);
   });
+  auto end = std::chrono::high_resolution_clock::now();
 
-  return it != _chunks.end();
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+  logger->trace("Meshing of {} chunks with neighbours took {}ms", jobs.size(), duration.count());
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (size_t i = 0; i < jobs.size(); i++) {
+    Chunk *current_chunk = chunks.find(jobs[i].pos);
+    // The chunk may have been unloaded (or reloaded) while meshing
+    if (current_chunk == nullptr || current_chunk->get_occupancy() != jobs[i].occupancy) {
+      world_model::free_mesh(meshes[i]);
+      continue;
+    }
+    current_chunk->set_mesh(std::make_unique<Mesh>(meshes[i]));
+  }
+}
+
+size_t world::upload_chunk_model(Chunk &current_chunk) {
+  std::unique_ptr<Mesh> chunk_mesh = current_chunk.take_mesh();
+  // No face (e.g. uniform chunk surrounded by solid chunks): no model at all
+  if (chunk_mesh->triangleCount == 0) {
+    world_model::free_mesh(*chunk_mesh);
+    current_chunk.unload_model();
+    return 0;
+  }
+  const size_t mesh_bytes = world_model::mesh_size_bytes(*chunk_mesh);
+  std::unique_ptr<Model> chunk_model = world_md.upload_chunk_model(*chunk_mesh);
+  chunk_model->materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = chunk_texture();
+
+  current_chunk.set_model(std::move(chunk_model));
+  return mesh_bytes;
+}
+
+std::vector<std::unique_ptr<Chunk>> world::load_saved_chunks(chunk_io &current_io, std::vector<benlib::Vector3i> &positions) {
+  std::vector<std::unique_ptr<Chunk>> loaded_chunks;
+  try {
+    loaded_chunks = current_io.read(positions).get();
+  } catch (const std::exception &error) {
+    // The chunks are generated instead
+    logger->error("Cannot load the saved chunks: {}", error.what());
+    return {};
+  }
+
+  std::vector<benlib::Vector3i> missing_positions;
+  size_t loaded_count = 0;
+  for (size_t i = 0; i < positions.size(); i++) {
+    if (loaded_chunks[i] == nullptr) {
+      missing_positions.push_back(positions[i]);
+      continue;
+    }
+    // Its trees reaching into chunks not generated yet, and the trees of chunks generated after this one was saved
+    batch_generator->republish_decorations(*loaded_chunks[i]);
+    batch_generator->apply_pending_decorations(*loaded_chunks[i]);
+    loaded_chunks[loaded_count++] = std::move(loaded_chunks[i]);
+  }
+  loaded_chunks.resize(loaded_count);
+  positions = std::move(missing_positions);
+  return loaded_chunks;
 }
 
+std::shared_ptr<chunk_io> world::open_storage(std::shared_ptr<Generator> baseline_generator) const {
+  if (!save_chunks) {
+    return nullptr;
+  }
+  const std::filesystem::path directory = save_directory / std::to_string(baseline_generator->get_seed());
+  try {
+    auto storage = std::make_shared<region_storage>(directory, region_compression_level, region_read);
+    // Deltas are relative to the terrain of this seed and these settings, the copy shares the pending structures of genv2
+    storage->set_save_mode(region_save, [baseline_generator](const benlib::Vector3i &pos) {
+      return baseline_generator->generate_baseline_chunk(pos.x, pos.y, pos.z);
+    });
+    logger->info("Chunks are saved in {}", directory.string());
+    return std::make_shared<chunk_io>(std::move(storage), io_write_delay);
+  } catch (const std::filesystem::filesystem_error &error) {
+    logger->error("Cannot open the save directory {}: {}", directory.string(), error.what());
+  }
+  return nullptr;
+}
+
+void world::save_loaded_chunks() {
+  if (storage_io == nullptr) {
+    return;
+  }
+  std::vector<std::unique_ptr<Chunk>> unsaved_chunks;
+  for (auto &current_chunk : chunks) {
+    if (storage_io->get_storage().needs_save(*current_chunk)) {
+      unsaved_chunks.push_back(save_snapshot(*current_chunk));
+    }
+    current_chunk->set_saved(true);
+  }
+  const size_t unsaved_count = unsaved_chunks.size();
+  // Written by the I/O thread, the render thread never waits for the disk
+  storage_io->write(std::move(unsaved_chunks));
+  logger->debug("Saved {} chunks", unsaved_count);
+}
+
+std::unique_ptr<Chunk> world::save_snapshot(const Chunk &current_chunk) {
+  const benlib::Vector3i pos = current_chunk.get_position();
+  auto snapshot = std::make_unique<Chunk>(current_chunk.get_storage(), pos.x, pos.y, pos.z);
+  snapshot->set_edited(current_chunk.is_edited());
+  return snapshot;
+}
+
+Texture2D world::chunk_texture() const noexcept {
+  // Greedy quads repeat the block tile, the other meshers sample the tile in the atlas
+  return world_md.mesher == mesher_type::greedy ? _game_context_ref._block_tile_texture : _game_context_ref._texture;
+}
+
+bool world::is_chunk_exist(const int32_t x, const int32_t y, const int32_t z) const noexcept { return chunks.contains(x, y, z); }
+
 void world::clear() {
   // Clear the chunks
   logger->debug("Clearing {} chunks...", chunks.size());
+  save_loaded_chunks();
   chunks.clear();
-  tmpChunks.clear();
+  generation_epoch++;
+  genv2.get_decoration_store().clear();
+  // Reseed: batches of the new seed start after this epoch, the next chunks come from another save directory, opened by the generation thread
+  if (reseed_requested) {
+    genv2.reseed(seed);
+    reseed_requested = false;
+  }
+  chunks_seed = genv2.get_seed();
   logger->debug("All chunks have been cleared");
+  reset_generation_stats();
+}
+
+void world::reset_generation_stats() {
+  generation_start_time = std::chrono::steady_clock::now();
+  first_chunk_pending = true;
+  first_visible_chunk_pending = true;
+  _game_context_ref.time_to_first_chunk_ms = -1.0;
+  _game_context_ref.time_to_first_visible_chunk_ms = -1.0;
 }
 
 void world::updateGameInput() {
   if (IsKeyPressed(KEY_R)) {
     seed = std::random_device()();
-    genv2.reseed(this->seed);
+    reseed_requested = true;
     free_world = true;
     logger->info("seed: {}", seed);
   }
@@ -92,25 +327,59 @@ void world::updateOpenglLogic() {
     return;
   }
 
-  // Check if each Chunk are outsite the unload distance, it yes, free it
-  for (auto it = chunks.begin(); it != chunks.end(); ++it) {
-    auto current_chunk = (*it).get();
-
-    if (current_chunk == nullptr) {
-      logger->warn("Chunk is nullptr");
+  // Free chunks flagged by the generation thread (outside the unload distance)
+  chunks.erase_if([](const Chunk &current_chunk) { return !current_chunk.is_active_chunk(); });
+
+  // Meshes are built by the generation thread, only upload them here, closest chunks first
+  const benlib::Vector3i player_chunk_pos = _game_context_ref.player_chunk_pos;
+  std::vector<std::pair<int32_t, Chunk *>> upload_queue;
+  size_t chunk_memory_bytes = 0;
+  size_t uniform_chunk_count = 0;
+  for (auto &current_chunk : chunks) {
+    chunk_memory_bytes += current_chunk->memory_bytes();
+    uniform_chunk_count += current_chunk->is_uniform() ? 1 : 0;
+    if (!current_chunk->has_mesh()) {
       continue;
     }
-
-    if (!current_chunk->is_active_chunk()) {
-      it = chunks.erase(it);
-      continue;
+    auto chunk_coor = current_chunk->get_position();
+    const int32_t dx = chunk_coor.x - player_chunk_pos.x;
+    const int32_t dy = chunk_coor.y - player_chunk_pos.y;
+    const int32_t dz = chunk_coor.z - player_chunk_pos.z;
+    upload_queue.push_back({dx * dx + dy * dy + dz * dz, current_chunk.get()});
+  }
+  std::sort(upload_queue.begin(), upload_queue.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  // Upload until the time or the bytes budget is spent, the rest waits for the next frames
+  const auto start = std::chrono::steady_clock::now();
+  size_t uploads = 0;
+  size_t upload_bytes = 0;
+  for (auto &[distance, current_chunk] : upload_queue) {
+    if (uploads > 0) {
+      const double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      if (upload_budget_ms > 0.0 && elapsed_ms >= upload_budget_ms) {
+        break;
+      }
+      if (upload_budget_bytes > 0 && upload_bytes >= upload_budget_bytes) {
+        break;
+      }
     }
 
-    if (!current_chunk->has_model()) {
-      generate_chunk_models(*current_chunk);
-      continue;
+    upload_bytes += upload_chunk_model(*current_chunk);
+    uploads++;
+
+    if (first_visible_chunk_pending && current_chunk->has_model()) {
+      first_visible_chunk_pending = false;
+      _game_context_ref.time_to_first_visible_chunk_ms =
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generation_start_time).count();
+      logger->info("Time to first visible chunk: {:.2f}ms", _game_context_ref.time_to_first_visible_chunk_ms);
     }
   }
+
+  _game_context_ref.upload_queue_size = upload_queue.size() - uploads;
+  _game_context_ref.uploads_per_frame = uploads;
+  _game_context_ref.upload_bytes_per_frame = upload_bytes;
+  _game_context_ref.chunk_memory_bytes = chunk_memory_bytes;
+  _game_context_ref.uniform_chunk_count = uniform_chunk_count;
 }
 
 void world::updateDraw3d() {
@@ -170,7 +439,6 @@ if (closest_collision.hit) {
 
     Chunk &current_chunk = *_chunk.get();
     auto chunk_coor = current_chunk.get_position();
-    [[maybe_unused]] auto &blocks = current_chunk.get_blocks();
 
     auto &player1_pose = _game_context_ref.player_chunk_pos;
 
@@ -224,60 +492,274 @@ void world::updateDraw2d() {}
 
 void world::updateDrawInterface() {}
 
+void world::schedule_missing_chunks(const benlib::Vector3i &player_chunk_pos) {
+  generation_queue.clear();
+  generation_queue.set_center(player_chunk_pos, _game_context_ref.player_view_direction);
+
+  for (int32_t x = -render_distance; x <= render_distance; x++) {
+    for (int32_t y = -render_distance; y <= render_distance; y++) {
+      for (int32_t z = -render_distance; z <= render_distance; z++) {
+        const int32_t chunk_x = player_chunk_pos.x + x;
+        const int32_t chunk_y = player_chunk_pos.y + y;
+        const int32_t chunk_z = player_chunk_pos.z + z;
+
+        if (is_chunk_exist(chunk_x, chunk_y, chunk_z)) {
+          continue;
+        }
+        generation_queue.push({chunk_x, chunk_y, chunk_z});
+      }
+    }
+  }
+}
+
 void world::generate_world_thread_func() {
   while (generate_world_thread_running) {
     if (free_world) {
+      generation_queue.clear();
       std::this_thread::sleep_for(std::chrono::milliseconds(20));
       continue;
     }
 
-    for (int32_t x = -render_distance; x <= render_distance; x++) {
-      for (int32_t y = -render_distance; y <= render_distance; y++) {
-        for (int32_t z = -render_distance; z <= render_distance; z++) {
-          int32_t chunk_x = _game_context_ref.player_chunk_pos.x + x;
-          int32_t chunk_y = _game_context_ref.player_chunk_pos.y + y;
-          int32_t chunk_z = _game_context_ref.player_chunk_pos.z + z;
+    // Reseed: the chunks of the previous seed were given to its storage by clear(), close it here (it writes its pending
+    // chunks and joins its thread) so the render thread never waits for it
+    std::shared_ptr<chunk_io> previous_io;
+    std::shared_ptr<Generator> baseline_generator;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (storage_seed != chunks_seed) {
+        previous_io = std::move(storage_io);
+        storage_seed = chunks_seed;
+        baseline_generator = std::make_shared<Generator>(genv2);
+      }
+    }
+    if (baseline_generator != nullptr) {
+      previous_io = nullptr;
+      std::shared_ptr<chunk_io> next_io = open_storage(std::move(baseline_generator));
+      std::lock_guard<std::mutex> lock(_mutex);
+      storage_io = std::move(next_io);
+    }
 
-          if (is_chunk_exist(chunks, chunk_x, chunk_y, chunk_z) || is_chunk_exist(tmpChunks, chunk_x, chunk_y, chunk_z)) {
-            continue;
+    // Rebuild the queue when it is drained or when the player crossed a chunk boundary, lookups are O(1)
+    // so the lock is held only briefly
+    bool region_batch = false;
+    // Generate the region in one piece (most of it is missing), per chunk otherwise
+    bool whole_region = false;
+    benlib::Vector3i region_begin;
+    int32_t region_size = 0;
+    std::vector<benlib::Vector3i> batch_positions;
+    std::shared_ptr<chunk_io> current_io;
+    uint64_t epoch = 0;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      current_io = storage_io;
+      epoch = generation_epoch;
+      // Settings of this epoch, a reseed in clear() never reaches a batch of the previous world
+      batch_generator->copy_settings(genv2);
+      const benlib::Vector3i player_chunk_pos = _game_context_ref.player_chunk_pos;
+      const benlib::Vector3i last_center = generation_queue.get_center();
+
+      // Teleport: restart time to first visible chunk
+      if (std::abs(player_chunk_pos.x - last_center.x) > 1 || std::abs(player_chunk_pos.y - last_center.y) > 1 ||
+          std::abs(player_chunk_pos.z - last_center.z) > 1) {
+        reset_generation_stats();
+      }
+
+      if (generation_queue.empty() || last_center.x != player_chunk_pos.x || last_center.y != player_chunk_pos.y || last_center.z != player_chunk_pos.z) {
+        schedule_missing_chunks(player_chunk_pos);
+      }
+      _game_context_ref.generation_queue_size = generation_queue.size();
+
+      // Spawn, teleport or reseed: nothing around the player yet, the whole area is generated as contiguous regions
+      const int32_t radius = std::min(region_batch_radius, render_distance);
+      region_batch = radius > 0 && !is_chunk_exist(player_chunk_pos.x, player_chunk_pos.y, player_chunk_pos.z);
+      region_begin = {player_chunk_pos.x - radius, player_chunk_pos.y - radius, player_chunk_pos.z - radius};
+      region_size = 2 * radius + 1;
+
+      // Only the chunks not loaded yet (the player may just outrun the generation), only this thread inserts chunks
+      if (region_batch) {
+        for (int32_t z = 0; z < region_size; z++) {
+          for (int32_t y = 0; y < region_size; y++) {
+            for (int32_t x = 0; x < region_size; x++) {
+              if (!is_chunk_exist(region_begin.x + x, region_begin.y + y, region_begin.z + z)) {
+                batch_positions.push_back({region_begin.x + x, region_begin.y + y, region_begin.z + z});
+              }
+            }
           }
-          tmpChunks.push_back(generateChunk(chunk_x, chunk_y, chunk_z, false));
         }
+        whole_region = batch_positions.size() * 2 > static_cast<size_t>(region_size * region_size * region_size);
       }
     }
 
-    if (!tmpChunks.empty()) {
-      std::lock_guard<std::mutex> lock(_mutex);
-      chunks.splice(chunks.end(), tmpChunks);
+    if (region_batch) {
+      auto start = std::chrono::high_resolution_clock::now();
+      generation_pool->copy_settings(*batch_generator);
+
+      // Saved chunks are loaded, the region is generated in one piece only if none is on disk and most of it is missing
+      std::vector<benlib::Vector3i> missing_positions = batch_positions;
+      std::vector<std::unique_ptr<Chunk>> loaded_chunks;
+      if (current_io != nullptr) {
+        loaded_chunks = load_saved_chunks(*current_io, missing_positions);
+      }
+      if (whole_region && loaded_chunks.empty()) {
+        tmpChunks = generation_pool->generate_region(region_begin, {region_size, region_size, region_size}, true);
+        // Drop the chunks of the region already loaded
+        if (missing_positions.size() != tmpChunks.size()) {
+          std::vector<chunk_registry::key_t> missing_keys;
+          missing_keys.reserve(missing_positions.size());
+          for (const auto &pos : missing_positions) {
+            missing_keys.push_back(chunk_registry::pack(pos));
+          }
+          std::sort(missing_keys.begin(), missing_keys.end());
+          std::erase_if(tmpChunks, [&](const std::unique_ptr<Chunk> &current_chunk) {
+            return !std::binary_search(missing_keys.begin(), missing_keys.end(), chunk_registry::pack(current_chunk->get_position()));
+          });
+        }
+      } else if (!missing_positions.empty()) {
+        tmpChunks = generation_pool->generateChunks(missing_positions, true);
+      }
+      std::move(loaded_chunks.begin(), loaded_chunks.end(), std::back_inserter(tmpChunks));
+      generate_chunk_meshes(tmpChunks);
+      auto end = std::chrono::high_resolution_clock::now();
+
+      auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+      logger->trace("Region generation of {} chunks took {}ms", tmpChunks.size(), duration.count());
+    } else {
+      // Generate the closest chunks first, publish them by small batches so they are drawn as soon as possible
+      const int32_t batch_size = generation_batch_size * static_cast<int32_t>(generation_pool->get_thread_count());
+      benlib::Vector3i chunk_pos;
+      for (int32_t i = 0; i < batch_size && generation_queue.pop(chunk_pos); i++) {
+        batch_positions.push_back(chunk_pos);
+      }
+
+      if (!batch_positions.empty()) {
+        auto start = std::chrono::high_resolution_clock::now();
+        generation_pool->copy_settings(*batch_generator);
+        std::vector<benlib::Vector3i> missing_positions = batch_positions;
+        std::vector<std::unique_ptr<Chunk>> loaded_chunks;
+        if (current_io != nullptr) {
+          loaded_chunks = load_saved_chunks(*current_io, missing_positions);
+        }
+        if (!missing_positions.empty()) {
+          tmpChunks = generation_pool->generateChunks(missing_positions, true);
+        }
+        std::move(loaded_chunks.begin(), loaded_chunks.end(), std::back_inserter(tmpChunks));
+        generate_chunk_meshes(tmpChunks);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        logger->trace("Generation of {} chunks ({} loaded from disk) took {}ms", tmpChunks.size(), tmpChunks.size() - missing_positions.size(),
+                      duration.count());
+      }
     }
 
-    // Check if each Chunk are outsite the unload distance, it yes, free it
-    for (auto it = chunks.begin(); it != chunks.end(); ++it) {
-      auto current_chunk = (*it).get();
-      if (current_chunk == nullptr) {
-        logger->warn("Chunk is nullptr");
+    std::vector<chunk_mesh_job> mesh_jobs;
+    // Copies of the chunks leaving the world, given to the I/O thread once the lock is released
+    std::vector<std::unique_ptr<Chunk>> unloaded_chunks;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      // The world was cleared during the batch (reseed or reload): its chunks and the structures it published belong to the
+      // previous world, and current_io may be the storage of the previous seed
+      if (epoch != generation_epoch) {
+        logger->debug("Dropping {} chunks generated before the world was cleared", tmpChunks.size());
+        tmpChunks.clear();
+        genv2.get_decoration_store().clear();
         continue;
       }
-      auto chunk_coor = current_chunk->get_position();
-      auto player_chunk_pos = _game_context_ref.player_chunk_pos;
 
-      // If Chunk is too far away, free it
-      if (std::abs(chunk_coor.x - player_chunk_pos.x) > unload_distance || std::abs(chunk_coor.y - player_chunk_pos.y) > unload_distance ||
-          std::abs(chunk_coor.z - player_chunk_pos.z) > unload_distance) {
-        current_chunk->set_active_chunk(false);
-        continue;
+      if (first_chunk_pending && !tmpChunks.empty()) {
+        first_chunk_pending = false;
+        _game_context_ref.time_to_first_chunk_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generation_start_time).count();
+        logger->info("Time to first chunk: {:.2f}ms", _game_context_ref.time_to_first_chunk_ms);
       }
 
-      // If Chunk is too far away, don't render it
-      if (std::abs(chunk_coor.x - player_chunk_pos.x) > view_distance || std::abs(chunk_coor.y - player_chunk_pos.y) > view_distance ||
-          std::abs(chunk_coor.z - player_chunk_pos.z) > view_distance) {
-        current_chunk->set_visible_chunk(false);
-        continue;
+      static_assert(std::tuple_size_v<decltype(_game_context_ref.generation_stage_us)> == terrain_stage_count);
+      const terrain_stage_times stage_times = generation_pool->get_stage_times();
+      for (size_t stage = 0; stage < terrain_stage_count; stage++) {
+        _game_context_ref.generation_stage_us[stage] =
+            stage_times.chunks == 0 ? 0.0 : static_cast<double>(stage_times.nanoseconds[stage]) / 1000.0 / static_cast<double>(stage_times.chunks);
+      }
+
+      if (current_io != nullptr) {
+        const latency_histogram read_latency = current_io->get_read_latency();
+        const latency_histogram write_latency = current_io->get_write_latency();
+        _game_context_ref.io_read_p99_us = read_latency.quantile_us(0.99);
+        _game_context_ref.io_write_p99_us = write_latency.quantile_us(0.99);
+        _game_context_ref.io_pending_writes = current_io->get_pending_writes();
+        _game_context_ref.io_failed_writes = current_io->get_failed_writes();
+      }
+
+      for (auto &new_chunk : tmpChunks) {
+        chunks.insert(std::move(new_chunk));
       }
-      current_chunk->set_visible_chunk(true);
+      tmpChunks.clear();
+
+      // Trees of the new chunks reaching into chunks already loaded: place their blocks now and mesh them again
+      std::vector<benlib::Vector3i> mesh_positions = batch_positions;
+      for (const auto &pos : genv2.get_decoration_store().take_dirty()) {
+        Chunk *decorated_chunk = chunks.find(pos);
+        if (decorated_chunk == nullptr || !genv2.apply_pending_decorations(*decorated_chunk)) {
+          continue;
+        }
+        decorated_chunk->set_occupancy(chunk_occupancy::make_shared(*decorated_chunk));
+        if (world_md.mesher != mesher_type::bitmask) {
+          decorated_chunk->set_mesh(std::make_unique<Mesh>(world_md.build_chunk_mesh(*decorated_chunk)));
+        }
+        mesh_positions.push_back(pos);
+      }
+      mesh_jobs = collect_chunk_mesh_jobs(mesh_positions);
+
+      // The region chunks are still in the queue
+      if (region_batch) {
+        schedule_missing_chunks(_game_context_ref.player_chunk_pos);
+      }
+
+      // Pending structure blocks of chunks far away, their source chunks are unloaded too and seed them again when reloaded
+      const benlib::Vector3i player_chunk_pos = _game_context_ref.player_chunk_pos;
+      genv2.get_decoration_store().erase_if([&](const benlib::Vector3i &pos) {
+        return std::abs(pos.x - player_chunk_pos.x) > unload_distance + 1 || std::abs(pos.y - player_chunk_pos.y) > unload_distance + 1 ||
+               std::abs(pos.z - player_chunk_pos.z) > unload_distance + 1;
+      });
+
+      // Check if each Chunk are outsite the unload distance, it yes, free it
+      for (auto &_chunk : chunks) {
+        Chunk *current_chunk = _chunk.get();
+        auto chunk_coor = current_chunk->get_position();
+        auto player_chunk_pos = _game_context_ref.player_chunk_pos;
+
+        // If Chunk is too far away, free it
+        if (std::abs(chunk_coor.x - player_chunk_pos.x) > unload_distance || std::abs(chunk_coor.y - player_chunk_pos.y) > unload_distance ||
+            std::abs(chunk_coor.z - player_chunk_pos.z) > unload_distance) {
+          if (current_io != nullptr && current_chunk->is_active_chunk() && current_io->get_storage().needs_save(*current_chunk)) {
+            unloaded_chunks.push_back(save_snapshot(*current_chunk));
+            current_chunk->set_saved(true);
+          }
+          current_chunk->set_active_chunk(false);
+          continue;
+        }
+
+        // If Chunk is too far away, don't render it
+        if (std::abs(chunk_coor.x - player_chunk_pos.x) > view_distance || std::abs(chunk_coor.y - player_chunk_pos.y) > view_distance ||
+            std::abs(chunk_coor.z - player_chunk_pos.z) > view_distance) {
+          current_chunk->set_visible_chunk(false);
+          continue;
+        }
+        current_chunk->set_visible_chunk(true);
+      }
+    }
+
+    if (!unloaded_chunks.empty()) {
+      logger->trace("Saving {} unloaded chunks", unloaded_chunks.size());
+      current_io->write(std::move(unloaded_chunks));
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    if (!mesh_jobs.empty()) {
+      run_chunk_mesh_jobs(mesh_jobs);
+    }
+
+    if (generation_queue.empty()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
   }
 
   logger->info("World generation thread stopped");
@@ -2,6 +2,7 @@
 #define WORLD_OF_CUBE_WORLD_HPP
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <filesystem>
 #include <future>
@@ -32,13 +33,27 @@
 // Cube lib
 #include "Block.hpp"
 #include "Chunk.hpp"
+#include "chunk_io.hpp"
+#include "chunk_occupancy.hpp"
+#include "chunk_registry.hpp"
+#include "chunk_scheduler.hpp"
 #include "gameElementHandler.hpp"
 #include "gameContext.hpp"
 #include "Generator.hpp"
+#include "GeneratorPool.hpp"
+#include "region_file.hpp"
 #include "world_model.hpp"
 
 #include "logger/logger_base.hpp"
 
+// Everything needed to mesh a chunk outside of the world lock (bitmask mesher)
+struct chunk_mesh_job {
+  benlib::Vector3i pos;
+  std::shared_ptr<const chunk_occupancy> occupancy;
+  // Indexed by world_model face, nullptr if the neighbour chunk is not loaded
+  std::array<std::shared_ptr<const chunk_occupancy>, 6> neighbours;
+};
+
 class world : public gameElementHandler {
 public:
   world(gameContext &game_context_ref, nlohmann::json &_config_json);
@@ -50,9 +65,30 @@ public:
 
   std::unique_ptr<Chunk> generateChunk(const int32_t, const int32_t, const int32_t, bool);
   void generate_chunk_models(Chunk &);
-  bool is_chunk_exist(std::list<std::unique_ptr<Chunk>>& _chunks, const int32_t, const int32_t, const int32_t) const noexcept;
+  // CPU stage of chunk meshing, run on the generation pool workers (build occupancy, and meshes if not using neighbour culling)
+  void generate_chunk_meshes(std::vector<std::unique_ptr<Chunk>> &);
+  // Mesh jobs of new chunks and of their loaded neighbours (faces on their shared border are culled), call with _mutex locked
+  std::vector<chunk_mesh_job> collect_chunk_mesh_jobs(const std::vector<benlib::Vector3i> &);
+  // Run mesh jobs on the generation pool workers and give the meshes to their chunks
+  void run_chunk_mesh_jobs(std::vector<chunk_mesh_job> &);
+  // GPU stage of chunk meshing, upload the mesh built by generate_chunk_meshes (OpenGL thread only), return uploaded bytes
+  size_t upload_chunk_model(Chunk &);
+  // Texture of the chunk models, depends on the mesher
+  [[nodiscard]] Texture2D chunk_texture() const noexcept;
+  bool is_chunk_exist(const int32_t, const int32_t, const int32_t) const noexcept;
+
+  // Chunks of positions saved on disk, loaded positions are removed from positions (the rest still has to be generated)
+  std::vector<std::unique_ptr<Chunk>> load_saved_chunks(chunk_io &current_io, std::vector<benlib::Vector3i> &positions);
+  // Region files of the seed of baseline_generator, nullptr if saves are disabled or the directory cannot be opened
+  [[nodiscard]] std::shared_ptr<chunk_io> open_storage(std::shared_ptr<Generator> baseline_generator) const;
+  // Give the loaded chunks not saved yet to the I/O thread, call with _mutex locked
+  void save_loaded_chunks();
+  // Copy of the blocks given to the I/O thread
+  [[nodiscard]] static std::unique_ptr<Chunk> save_snapshot(const Chunk &current_chunk);
 
   void generate_world_thread_func();
+  void schedule_missing_chunks(const benlib::Vector3i &player_chunk_pos);
+  void reset_generation_stats();
 
   void clear();
 
@@ -65,13 +101,54 @@ public:
   void updateDrawInterface() override;
 
   int32_t seed = 251058607;
+  // Seed chosen by the player, genv2 is reseeded by clear() once the chunks of the previous seed are saved. Only used by the render thread
+  bool reseed_requested = false;
 
   Generator genv2 = Generator(seed);
+  // Settings of the current batch, copied from genv2 with the batch epoch (shares its pending structures). Only used by the generation thread
+  std::unique_ptr<Generator> batch_generator;
+  // Worker pool generating chunks concurrently, copies batch_generator settings before each batch
+  std::unique_ptr<GeneratorPool> generation_pool;
 
   world_model world_md = world_model();
 
-  std::list<std::unique_ptr<Chunk>> chunks;
-  std::list<std::unique_ptr<Chunk>> tmpChunks;
+  // Chunks are saved when unloaded and loaded from disk before being generated, one directory per seed.
+  // Reads and writes go through the I/O thread
+  std::shared_ptr<chunk_io> storage_io;
+  // Seed of storage_io and seed of the chunks since the last clear(), the generation thread switches the storage when they
+  // differ: closing a storage waits for its pending writes. Guarded by _mutex
+  uint32_t storage_seed = 0;
+  uint32_t chunks_seed = 0;
+  bool save_chunks = true;
+  std::filesystem::path save_directory = "saves";
+  int32_t region_compression_level = 1;
+  region_read_mode region_read = region_read_mode::mmap;
+  // Delta: only the edits of edited chunks are saved, chunks are regenerated when loaded
+  region_save_mode region_save = region_save_mode::full;
+  // Time unloaded chunks wait on the I/O thread to be coalesced with newer writes
+  std::chrono::milliseconds io_write_delay = std::chrono::milliseconds(100);
+
+  chunk_registry chunks;
+  // Chunks of the current batch, only used by the generation thread
+  std::vector<std::unique_ptr<Chunk>> tmpChunks;
+  // Bumped by clear() (reseed or reload), batches started in a previous epoch are dropped. Guarded by _mutex
+  uint64_t generation_epoch = 0;
+
+  // Pending chunks ordered by distance to the player, only used by the generation thread
+  chunk_scheduler generation_queue;
+  // Number of chunks generated per worker before publishing them to the render thread
+  int32_t generation_batch_size = 8;
+  // Radius (in chunks) of the area generated as contiguous regions when the player chunk is missing (spawn, teleport, reseed), 0: disabled
+  int32_t region_batch_radius = 2;
+
+  // Per frame GPU upload budget, at least one mesh is uploaded per frame, 0: unlimited
+  double upload_budget_ms = 2.0;
+  size_t upload_budget_bytes = 8 * 1024 * 1024;
+
+  // Time to first visible chunk after (re)loading the world
+  std::chrono::steady_clock::time_point generation_start_time = std::chrono::steady_clock::now();
+  bool first_chunk_pending = true;
+  bool first_visible_chunk_pending = true;
 
   int32_t render_distance = 4;
   int32_t view_distance = 6;
@@ -1,5 +1,11 @@
 
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <iterator>
+
 #include "world_model.hpp"
 
 world_model::world_model() { world_model_logger = std::make_unique<LoggerDecorator>("world_model_logger", "world_model_logger.log"); }
@@ -139,6 +145,75 @@ inline void world_model::add_cube(Mesh &mesh, size_t &triangle_index, size_t &ve
   }
 }
 
+namespace {
+// Indexed faces: 4 corners per face, triangles (0, 1, 2) and (0, 2, 3), same winding and face order as world_model::add_cube
+constexpr float quad_corners[6][4][3] = {
+    {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}}, // south (z+)
+    {{1, 1, 0}, {1, 0, 0}, {0, 0, 0}, {0, 1, 0}}, // north (z-)
+    {{1, 0, 1}, {1, 0, 0}, {1, 1, 0}, {1, 1, 1}}, // west (x+)
+    {{0, 1, 0}, {0, 0, 0}, {0, 0, 1}, {0, 1, 1}}, // east (x-)
+    {{1, 1, 1}, {1, 1, 0}, {0, 1, 0}, {0, 1, 1}}, // up (y+)
+    {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}, // down (y-)
+};
+constexpr float quad_texcoords[6][4][2] = {
+    {{0.25f, 0}, {0.5f, 0}, {0.5f, 1}, {0.25f, 1}}, // south (z+)
+    {{0.5f, 1}, {0.5f, 0}, {0.25f, 0}, {0.25f, 1}}, // north (z-)
+    {{0.25f, 1}, {0.25f, 0}, {0.5f, 0}, {0.5f, 1}}, // west (x+)
+    {{0.5f, 0}, {0.25f, 0}, {0.25f, 1}, {0.5f, 1}}, // east (x-)
+    {{0.5f, 1}, {0.5f, 0}, {0.25f, 0}, {0.25f, 1}}, // up (y+)
+    {{0.25f, 0}, {0.5f, 0}, {0.5f, 1}, {0.25f, 1}}, // down (y-)
+};
+constexpr float quad_normals[6][3] = {{0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}};
+constexpr unsigned short quad_indices[6] = {0, 1, 2, 0, 2, 3};
+// add_cube emits faces in this order
+constexpr size_t add_cube_face_order[6] = {world_model::north_face, world_model::south_face, world_model::west_face,
+                                           world_model::east_face,  world_model::up_face,    world_model::down_face};
+} // namespace
+
+inline void world_model::add_cube_indexed(Mesh &mesh, size_t &quad_index, const Vector3 &position, bool faces[6]) noexcept {
+  for (const size_t face : add_cube_face_order) {
+    if (!faces[face]) {
+      continue;
+    }
+    const size_t first_vertex = quad_index * 4;
+    for (size_t corner = 0; corner < 4; corner++) {
+      const size_t vertex = first_vertex + corner;
+      mesh.vertices[vertex * 3] = position.x + quad_corners[face][corner][0];
+      mesh.vertices[vertex * 3 + 1] = position.y + quad_corners[face][corner][1];
+      mesh.vertices[vertex * 3 + 2] = position.z + quad_corners[face][corner][2];
+
+      mesh.normals[vertex * 3] = quad_normals[face][0];
+      mesh.normals[vertex * 3 + 1] = quad_normals[face][1];
+      mesh.normals[vertex * 3 + 2] = quad_normals[face][2];
+
+      mesh.texcoords[vertex * 2] = quad_texcoords[face][corner][0];
+      mesh.texcoords[vertex * 2 + 1] = quad_texcoords[face][corner][1];
+    }
+    for (size_t i = 0; i < 6; i++) {
+      mesh.indices[quad_index * 6 + i] = static_cast<unsigned short>(first_vertex + quad_indices[i]);
+    }
+    quad_index++;
+  }
+}
+
+Mesh world_model::allocate_face_mesh(const size_t faces_count) const noexcept {
+  Mesh mesh = {0};
+  mesh.triangleCount = static_cast<int>(faces_count * 2);
+
+  // raylib indices are 16 bits, meshes with too many vertices stay un-indexed
+  if (indexed_meshes && faces_count * 4 <= max_indexed_vertices) {
+    mesh.vertexCount = static_cast<int>(faces_count * 4);
+    mesh.indices = static_cast<unsigned short *>(MemAlloc(sizeof(unsigned short) * 6 * faces_count));
+  } else {
+    mesh.vertexCount = static_cast<int>(faces_count * 6);
+  }
+
+  mesh.vertices = static_cast<float *>(MemAlloc(sizeof(float) * 3 * mesh.vertexCount));
+  mesh.normals = static_cast<float *>(MemAlloc(sizeof(float) * 3 * mesh.vertexCount));
+  mesh.texcoords = static_cast<float *>(MemAlloc(sizeof(float) * 2 * mesh.vertexCount));
+  return mesh;
+}
+
 std::vector<std::unique_ptr<Model>> world_model::generate_world_models(std::vector<Chunk> &chunks) {
   std::vector<std::unique_ptr<Model>> models;
   std::vector<Mesh> meshes;
@@ -147,7 +222,7 @@ std::vector<std::unique_ptr<Model>> world_model::generate_world_models(std::vect
 // Generate meshes on multiple threads
 #pragma omp for ordered schedule(static, 1)
   for (size_t i = 0; i < chunks.size(); i++) {
-    Mesh mesh = generate_chunk_mesh(chunks[i]);
+    Mesh mesh = build_chunk_mesh(chunks[i]);
 #pragma omp ordered
     meshes.push_back(std::move(mesh));
   }
@@ -160,12 +235,42 @@ std::vector<std::unique_ptr<Model>> world_model::generate_world_models(std::vect
 }
 
 std::unique_ptr<Model> world_model::generate_chunk_model(Chunk &chunks) {
-  Mesh mesh = generate_chunk_mesh(chunks);
+  Mesh mesh = build_chunk_mesh(chunks);
+  return upload_chunk_model(mesh);
+}
+
+std::unique_ptr<Model> world_model::upload_chunk_model(Mesh &mesh) {
   UploadMesh(&mesh, false);
   std::unique_ptr<Model> model = std::make_unique<Model>(std::move(LoadModelFromMesh(mesh)));
   return model;
 }
 
+void world_model::free_mesh(Mesh &mesh) noexcept {
+  MemFree(mesh.vertices);
+  MemFree(mesh.normals);
+  MemFree(mesh.texcoords);
+  MemFree(mesh.indices);
+  mesh = {0};
+}
+
+size_t world_model::mesh_size_bytes(const Mesh &mesh) noexcept {
+  const size_t vertex_count = static_cast<size_t>(mesh.vertexCount);
+  size_t size = 0;
+  if (mesh.vertices != nullptr) {
+    size += vertex_count * 3 * sizeof(float);
+  }
+  if (mesh.normals != nullptr) {
+    size += vertex_count * 3 * sizeof(float);
+  }
+  if (mesh.texcoords != nullptr) {
+    size += vertex_count * 2 * sizeof(float);
+  }
+  if (mesh.indices != nullptr) {
+    size += static_cast<size_t>(mesh.triangleCount) * 3 * sizeof(unsigned short);
+  }
+  return size;
+}
+
 inline bool world_model::block_is_solid(int x, int y, int z, Chunk &_chunk) noexcept {
   // Check out of bounds
   if (x < 0 || x >= Chunk::chunk_size_x) {
@@ -224,7 +329,7 @@ int world_model::chunk_face_count(Chunk &_chunk) noexcept {
   for (int x = 0; x < Chunk::chunk_size_x; x++) {
     for (int y = 0; y < Chunk::chunk_size_y; y++) {
       for (int z = 0; z < Chunk::chunk_size_z; z++) {
-        Block &current_block = _chunk.get_block(x, y, z);
+        Block current_block = _chunk.get_block(x, y, z);
         if (current_block.block_type == block_type::air)
           continue;
 
@@ -259,23 +364,19 @@ int world_model::chunk_face_count(Chunk &_chunk) noexcept {
 }
 
 Mesh world_model::generate_chunk_mesh(Chunk &Chunk) noexcept {
-  Mesh mesh = {0};
   int faces_count = chunk_face_count(Chunk);
-  mesh.vertexCount = faces_count * 6;
-  mesh.triangleCount = faces_count * 2;
-
-  mesh.vertices = static_cast<float *>(MemAlloc(sizeof(float) * 3 * mesh.vertexCount));
-  mesh.normals = static_cast<float *>(MemAlloc(sizeof(float) * 3 * mesh.vertexCount));
-  mesh.texcoords = static_cast<float *>(MemAlloc(sizeof(float) * 2 * mesh.vertexCount));
+  Mesh mesh = allocate_face_mesh(static_cast<size_t>(faces_count));
+  const bool indexed = mesh.indices != nullptr;
 
   size_t triangle_index = 0;
   size_t vert_index = 0;
+  size_t quad_index = 0;
 
   //[[maybe_unused]] auto &blocks = Chunk.get_blocks();
   for (int x = 0; x < Chunk::chunk_size_x; x++) {
     for (int y = 0; y < Chunk::chunk_size_y; y++) {
       for (int z = 0; z < Chunk::chunk_size_z; z++) {
-        Block &current_block = Chunk.get_block(x, y, z);
+        Block current_block = Chunk.get_block(x, y, z);
         if (current_block.block_type == block_type::air) {
           continue;
         }
@@ -301,9 +402,360 @@ Mesh world_model::generate_chunk_mesh(Chunk &Chunk) noexcept {
 
         faces[world_model::north_face] = !block_is_solid(x, y, z - 1, Chunk);
 
-        add_cube(mesh, triangle_index, vert_index, {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)}, faces, current_block);
+        const Vector3 position = {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)};
+        if (indexed) {
+          add_cube_indexed(mesh, quad_index, position, faces);
+        } else {
+          add_cube(mesh, triangle_index, vert_index, position, faces, current_block);
+        }
+      }
+    }
+  }
+  return mesh;
+}
+
+mesher_type world_model::mesher_from_string(const std::string &name) noexcept {
+  if (name == "greedy") {
+    return mesher_type::greedy;
+  }
+  if (name == "single_pass") {
+    return mesher_type::single_pass;
+  }
+  if (name == "bitmask") {
+    return mesher_type::bitmask;
+  }
+  return mesher_type::naive;
+}
+
+Mesh world_model::build_chunk_mesh(Chunk &Chunk) noexcept {
+  switch (mesher) {
+  case mesher_type::greedy:
+    return generate_chunk_mesh_greedy(Chunk);
+  case mesher_type::single_pass:
+    return generate_chunk_mesh_single_pass(Chunk);
+  case mesher_type::bitmask:
+    return generate_chunk_mesh_bitmask(Chunk);
+  case mesher_type::naive:
+  default:
+    return generate_chunk_mesh(Chunk);
+  }
+}
+
+namespace {
+// Per thread vertex buffers reused between chunks, only grow
+struct mesh_scratch {
+  std::vector<float> vertices;
+  std::vector<float> normals;
+  std::vector<float> texcoords;
+
+  // Make room for vertex_count vertices and point the mesh to the buffers
+  void reserve(Mesh &mesh, const size_t vertex_count) {
+    if (vertices.size() < vertex_count * 3) {
+      // Grow geometrically to amortize the copies
+      const size_t new_count = std::max(vertex_count, vertices.size() / 3 * 2);
+      vertices.resize(new_count * 3);
+      normals.resize(new_count * 3);
+      texcoords.resize(new_count * 2);
+    }
+    mesh.vertices = vertices.data();
+    mesh.normals = normals.data();
+    mesh.texcoords = texcoords.data();
+  }
+};
+
+// Merged rectangle of faces, (u, v) are the in-plane axes of the face direction
+struct greedy_quad {
+  size_t face;
+  int slice;
+  int u;
+  int v;
+  int width;
+  int height;
+};
+
+// Axis of the face normal and in-plane axes (0: x, 1: y, 2: z), indexed by face
+constexpr int face_normal_axis[6] = {2, 2, 0, 0, 1, 1};
+constexpr int face_u_axis[6] = {0, 0, 2, 2, 0, 0};
+constexpr int face_v_axis[6] = {1, 1, 1, 1, 2, 2};
+// Normal direction sign, indexed by face
+constexpr int face_direction[6] = {1, -1, 1, -1, 1, -1};
+
+// Corners (a, b) of the two triangles of each face, same winding as world_model::add_cube
+constexpr int face_corners[6][6][2] = {
+    {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}}, // south (z+)
+    {{0, 0}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}}, // north (z-)
+    {{1, 0}, {0, 0}, {0, 1}, {1, 0}, {0, 1}, {1, 1}}, // west (x+)
+    {{1, 0}, {0, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 1}}, // east (x-)
+    {{0, 0}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}}, // up (y+)
+    {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}}, // down (y-)
+};
+
+// Tile coordinates (0 or 1 on each axis) of the in-plane corner (a, b) of a face, as textured by add_cube_indexed
+constexpr std::array<float, 2> face_tile_coords(const size_t face, const int a, const int b) noexcept {
+  int block_corner[3] = {0, 0, 0};
+  block_corner[face_normal_axis[face]] = face_direction[face] > 0 ? 1 : 0;
+  block_corner[face_u_axis[face]] = a;
+  block_corner[face_v_axis[face]] = b;
+  for (size_t corner = 0; corner < 4; corner++) {
+    if (quad_corners[face][corner][0] == block_corner[0] && quad_corners[face][corner][1] == block_corner[1] &&
+        quad_corners[face][corner][2] == block_corner[2]) {
+      return {(quad_texcoords[face][corner][0] - world_model::atlas_block_tile.x) / world_model::atlas_block_tile.width,
+              (quad_texcoords[face][corner][1] - world_model::atlas_block_tile.y) / world_model::atlas_block_tile.height};
+    }
+  }
+  return {0.0f, 0.0f};
+}
+} // namespace
+
+Mesh world_model::generate_chunk_mesh_greedy(Chunk &Chunk) noexcept {
+  static_assert(Chunk::chunk_size_x == Chunk::chunk_size_y && Chunk::chunk_size_y == Chunk::chunk_size_z, "Greedy mesher expects cubic chunks");
+  constexpr int size = Chunk::chunk_size_x;
+
+  // Visible faces of each block (1 bit per face), same face set as generate_chunk_mesh
+  std::vector<uint8_t> visible_faces(size * size * size, 0);
+  for (int z = 0; z < size; z++) {
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        if (!block_is_solid(x, y, z, Chunk)) {
+          continue;
+        }
+        // Buried blocks (border counted as solid) have no face
+        if (count_neighbours(x, y, z, Chunk) + block_count_border(x, y, z, Chunk) == 6) {
+          continue;
+        }
+        uint8_t faces = 0;
+        faces |= static_cast<uint8_t>(!block_is_solid(x, y, z + 1, Chunk)) << south_face;
+        faces |= static_cast<uint8_t>(!block_is_solid(x, y, z - 1, Chunk)) << north_face;
+        faces |= static_cast<uint8_t>(!block_is_solid(x + 1, y, z, Chunk)) << west_face;
+        faces |= static_cast<uint8_t>(!block_is_solid(x - 1, y, z, Chunk)) << east_face;
+        faces |= static_cast<uint8_t>(!block_is_solid(x, y + 1, z, Chunk)) << up_face;
+        faces |= static_cast<uint8_t>(!block_is_solid(x, y - 1, z, Chunk)) << down_face;
+        visible_faces[math::convert_to_1d(x, y, z, size, size, size)] = faces;
+      }
+    }
+  }
+
+  std::vector<greedy_quad> quads;
+  // Block type of the visible face at (u, v) in the current slice, air if no face
+  std::vector<block_type::block_t> mask(size * size);
+
+  for (size_t face = 0; face < 6; face++) {
+    const int n_axis = face_normal_axis[face];
+    const int u_axis = face_u_axis[face];
+    const int v_axis = face_v_axis[face];
+
+    for (int slice = 0; slice < size; slice++) {
+      // Build the face mask of the slice
+      for (int v = 0; v < size; v++) {
+        for (int u = 0; u < size; u++) {
+          int pos[3];
+          pos[n_axis] = slice;
+          pos[u_axis] = u;
+          pos[v_axis] = v;
+
+          const size_t index = math::convert_to_1d(pos[0], pos[1], pos[2], size, size, size);
+          mask[v * size + u] = (visible_faces[index] >> face) & 1 ? Chunk.get_block(pos[0], pos[1], pos[2]).block_type : block_type::air;
+        }
+      }
+
+      // Merge the mask into maximal rectangles: extend along u, then along v while the whole row matches
+      for (int v = 0; v < size; v++) {
+        for (int u = 0; u < size;) {
+          const block_type::block_t type = mask[v * size + u];
+          if (type == block_type::air) {
+            u++;
+            continue;
+          }
+
+          int width = 1;
+          while (u + width < size && mask[v * size + u + width] == type) {
+            width++;
+          }
+
+          int height = 1;
+          for (; v + height < size; height++) {
+            bool row_match = true;
+            for (int k = 0; k < width; k++) {
+              if (mask[(v + height) * size + u + k] != type) {
+                row_match = false;
+                break;
+              }
+            }
+            if (!row_match) {
+              break;
+            }
+          }
+
+          for (int h = 0; h < height; h++) {
+            std::fill_n(mask.begin() + (v + h) * size + u, width, block_type::air);
+          }
+
+          quads.push_back({face, slice, u, v, width, height});
+          u += width;
+        }
+      }
+    }
+  }
+
+  Mesh mesh = {0};
+  mesh.vertexCount = static_cast<int>(quads.size() * 6);
+  mesh.triangleCount = static_cast<int>(quads.size() * 2);
+
+  mesh.vertices = static_cast<float *>(MemAlloc(sizeof(float) * 3 * mesh.vertexCount));
+  mesh.normals = static_cast<float *>(MemAlloc(sizeof(float) * 3 * mesh.vertexCount));
+  mesh.texcoords = static_cast<float *>(MemAlloc(sizeof(float) * 2 * mesh.vertexCount));
+
+  size_t vertex = 0;
+  for (const auto &quad : quads) {
+    const int n_axis = face_normal_axis[quad.face];
+    const int u_axis = face_u_axis[quad.face];
+    const int v_axis = face_v_axis[quad.face];
+
+    float normal[3] = {0.0f, 0.0f, 0.0f};
+    normal[n_axis] = static_cast<float>(face_direction[quad.face]);
+    // Faces pointing to + are on the far side of the block
+    const float plane = static_cast<float>(quad.slice + (face_direction[quad.face] > 0 ? 1 : 0));
+
+    for (const auto &corner : face_corners[quad.face]) {
+      float position[3];
+      position[n_axis] = plane;
+      position[u_axis] = static_cast<float>(quad.u + corner[0] * quad.width);
+      position[v_axis] = static_cast<float>(quad.v + corner[1] * quad.height);
+
+      mesh.vertices[vertex * 3] = position[0];
+      mesh.vertices[vertex * 3 + 1] = position[1];
+      mesh.vertices[vertex * 3 + 2] = position[2];
+
+      mesh.normals[vertex * 3] = normal[0];
+      mesh.normals[vertex * 3 + 1] = normal[1];
+      mesh.normals[vertex * 3 + 2] = normal[2];
+
+      // The tile is repeated once per block along the quad: tile coordinates are affine in (a, b), scaled by the quad size
+      const auto origin = face_tile_coords(quad.face, 0, 0);
+      const auto along_u = face_tile_coords(quad.face, 1, 0);
+      const auto along_v = face_tile_coords(quad.face, 0, 1);
+      for (size_t axis = 0; axis < 2; axis++) {
+        mesh.texcoords[vertex * 2 + axis] = origin[axis] + (along_u[axis] - origin[axis]) * static_cast<float>(corner[0] * quad.width) +
+                                            (along_v[axis] - origin[axis]) * static_cast<float>(corner[1] * quad.height);
+      }
+      vertex++;
+    }
+  }
+  return mesh;
+}
+
+Mesh world_model::generate_chunk_mesh_single_pass(Chunk &Chunk) noexcept {
+  thread_local mesh_scratch scratch;
+
+  // Mesh pointing to the scratch buffers while filling them
+  Mesh scratch_mesh = {0};
+  size_t triangle_index = 0;
+  size_t vert_index = 0;
+
+  for (int x = 0; x < Chunk::chunk_size_x; x++) {
+    for (int y = 0; y < Chunk::chunk_size_y; y++) {
+      for (int z = 0; z < Chunk::chunk_size_z; z++) {
+        Block current_block = Chunk.get_block(x, y, z);
+        if (current_block.block_type == block_type::air) {
+          continue;
+        }
+
+        int border_count = block_count_border(x, y, z, Chunk);
+        int neighbour_count = count_neighbours(x, y, z, Chunk);
+
+        if (neighbour_count + border_count == 6) {
+          continue;
+        }
+
+        bool faces[6] = {false, false, false, false, false, false};
+
+        faces[world_model::east_face] = !block_is_solid(x - 1, y, z, Chunk);
+        faces[world_model::west_face] = !block_is_solid(x + 1, y, z, Chunk);
+        faces[world_model::down_face] = !block_is_solid(x, y - 1, z, Chunk);
+        faces[world_model::up_face] = !block_is_solid(x, y + 1, z, Chunk);
+        faces[world_model::south_face] = !block_is_solid(x, y, z + 1, Chunk);
+        faces[world_model::north_face] = !block_is_solid(x, y, z - 1, Chunk);
+
+        const size_t face_count = std::count(std::begin(faces), std::end(faces), true);
+        if (face_count == 0) {
+          continue;
+        }
+        scratch.reserve(scratch_mesh, triangle_index * 3 + face_count * 6);
+
+        add_cube(scratch_mesh, triangle_index, vert_index, {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)}, faces, current_block);
+      }
+    }
+  }
+
+  // Copy once into the final mesh
+  Mesh mesh = {0};
+  mesh.vertexCount = static_cast<int>(triangle_index * 3);
+  mesh.triangleCount = static_cast<int>(triangle_index);
+
+  mesh.vertices = static_cast<float *>(MemAlloc(sizeof(float) * 3 * mesh.vertexCount));
+  mesh.normals = static_cast<float *>(MemAlloc(sizeof(float) * 3 * mesh.vertexCount));
+  mesh.texcoords = static_cast<float *>(MemAlloc(sizeof(float) * 2 * mesh.vertexCount));
+
+  if (mesh.vertexCount > 0) {
+    std::memcpy(mesh.vertices, scratch.vertices.data(), sizeof(float) * 3 * mesh.vertexCount);
+    std::memcpy(mesh.normals, scratch.normals.data(), sizeof(float) * 3 * mesh.vertexCount);
+    std::memcpy(mesh.texcoords, scratch.texcoords.data(), sizeof(float) * 2 * mesh.vertexCount);
+  }
+  return mesh;
+}
+
+Mesh world_model::generate_chunk_mesh_bitmask(Chunk &Chunk) noexcept {
+  const chunk_occupancy occupancy = chunk_occupancy::build(Chunk);
+  return generate_chunk_mesh_bitmask(occupancy, nullptr);
+}
+
+Mesh world_model::generate_chunk_mesh_bitmask(const chunk_occupancy &occupancy, const chunk_occupancy *const *neighbours) noexcept {
+
+  // Count faces with popcount to allocate the mesh exactly
+  size_t faces_count = 0;
+  for (int x = 0; x < Chunk::chunk_size_x; x++) {
+    for (int y = 0; y < Chunk::chunk_size_y; y++) {
+      uint32_t faces[6];
+      occupancy.row_faces(x, y, faces, neighbours);
+      for (size_t face = 0; face < 6; face++) {
+        faces_count += static_cast<size_t>(std::popcount(faces[face]));
+      }
+    }
+  }
+
+  Mesh mesh = allocate_face_mesh(faces_count);
+  const bool indexed = mesh.indices != nullptr;
+
+  size_t triangle_index = 0;
+  size_t vert_index = 0;
+  size_t quad_index = 0;
+  // Block type is not used by add_cube
+  Block solid_block(block_type::stone);
+
+  // Same block order as generate_chunk_mesh (z innermost): the output is identical
+  for (int x = 0; x < Chunk::chunk_size_x; x++) {
+    for (int y = 0; y < Chunk::chunk_size_y; y++) {
+      uint32_t faces[6];
+      occupancy.row_faces(x, y, faces, neighbours);
+
+      uint32_t blocks_with_faces = faces[0] | faces[1] | faces[2] | faces[3] | faces[4] | faces[5];
+      while (blocks_with_faces != 0) {
+        const int z = std::countr_zero(blocks_with_faces);
+        blocks_with_faces &= blocks_with_faces - 1;
+
+        bool block_faces[6];
+        for (size_t face = 0; face < 6; face++) {
+          block_faces[face] = (faces[face] >> z) & 1u;
+        }
+
+        const Vector3 position = {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)};
+        if (indexed) {
+          add_cube_indexed(mesh, quad_index, position, block_faces);
+        } else {
+          add_cube(mesh, triangle_index, vert_index, position, block_faces, solid_block);
+        }
       }
     }
   }
   return mesh;
-}
\ No newline at end of file
+}
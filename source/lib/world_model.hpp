@@ -1,5 +1,9 @@
 #ifndef WORLD_OF_CUBE_WORLD_MODEL_HPP
 #define WORLD_OF_CUBE_WORLD_MODEL_HPP
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <omp.h>
@@ -9,11 +13,24 @@
 // Cube lib
 #include "Block.hpp"
 #include "Chunk.hpp"
+#include "chunk_occupancy.hpp"
 #include "math.hpp"
 
 // spdlog
 #include "logger/logger_facade.hpp"
 
+// Chunk mesh algorithms
+enum class mesher_type : uint8_t {
+  // One quad per visible block face
+  naive = 0,
+  // Coplanar adjacent faces of the same block type are merged into maximal rectangles
+  greedy = 1,
+  // Same output as naive in a single sweep, without the chunk_face_count pre-pass
+  single_pass = 2,
+  // Same output as naive, face culling done 32 blocks at a time on occupancy bit rows
+  bitmask = 3,
+};
+
 class world_model {
 public:
   world_model();
@@ -27,14 +44,32 @@ public:
   static constexpr size_t up_face = 4;
   static constexpr size_t down_face = 5;
 
+  // Block tile in the texture atlas (x, y, width, height in texture coordinates), sampled by the naive, single pass and bitmask meshers
+  static constexpr Rectangle atlas_block_tile = {0.25f, 0.0f, 0.25f, 1.0f};
+
   inline void add_vertex(Mesh &mesh, size_t &triangle_index, size_t &vert_index, const Vector3 &vertex, const Vector3 &offset, const Vector3 &normal,
                          const Vector2 &texcoords) noexcept;
 
   inline void add_cube(Mesh &mesh, size_t &triangle_index, size_t &vert_index, const Vector3 &position, bool faces[6], Block &current_block) noexcept;
 
+  // Indexed version of add_cube: 4 vertices and 6 indices per face
+  inline void add_cube_indexed(Mesh &mesh, size_t &quad_index, const Vector3 &position, bool faces[6]) noexcept;
+
+  // Allocate a mesh for faces_count faces, indexed if indexed_meshes is set and the vertices fit in 16 bit indices
+  Mesh allocate_face_mesh(size_t faces_count) const noexcept;
+
   std::vector<std::unique_ptr<Model>> generate_world_models(std::vector<Chunk> &Chunk);
   std::unique_ptr<Model> generate_chunk_model(Chunk &chunks);
 
+  // GPU stage: upload a mesh built by generate_chunk_mesh, must be called from the OpenGL thread
+  std::unique_ptr<Model> upload_chunk_model(Mesh &mesh);
+
+  // Free the CPU buffers of a mesh never uploaded, no OpenGL call
+  static void free_mesh(Mesh &mesh) noexcept;
+
+  // Size of the CPU buffers of a mesh, i.e. bytes sent to the GPU by upload_chunk_model
+  [[nodiscard]] static size_t mesh_size_bytes(const Mesh &mesh) noexcept;
+
   inline bool block_is_solid(int x, int y, int z, Chunk &_chunk) noexcept;
 
   inline int count_neighbours(int x, int y, int z, Chunk &_chunk) noexcept;
@@ -45,6 +80,28 @@ public:
 
   Mesh generate_chunk_mesh(Chunk &Chunk) noexcept;
 
+  // Texture coordinates are in tile units (0 to the quad size in blocks), to draw with a texture of the atlas block tile alone
+  // in repeat wrap mode (see gameContext::_block_tile_texture), with the same orientation as the other meshers
+  Mesh generate_chunk_mesh_greedy(Chunk &Chunk) noexcept;
+
+  Mesh generate_chunk_mesh_single_pass(Chunk &Chunk) noexcept;
+
+  Mesh generate_chunk_mesh_bitmask(Chunk &Chunk) noexcept;
+
+  // Only needs the occupancy, faces against solid blocks of the neighbour chunks (indexed by face, nullptr if not loaded) are culled
+  Mesh generate_chunk_mesh_bitmask(const chunk_occupancy &occupancy, const chunk_occupancy *const *neighbours) noexcept;
+
+  // Build the chunk mesh with the selected mesher
+  Mesh build_chunk_mesh(Chunk &Chunk) noexcept;
+
+  [[nodiscard]] static mesher_type mesher_from_string(const std::string &name) noexcept;
+
+  mesher_type mesher = mesher_type::naive;
+
+  // Naive and bitmask meshers share the 4 vertices of each face through an index buffer (greedy and single_pass are not indexed)
+  bool indexed_meshes = false;
+  static constexpr size_t max_indexed_vertices = 65536;
+
   // logger
   std::unique_ptr<LoggerDecorator> world_model_logger;
 };
@@ -36,6 +36,28 @@ auto main(int [[maybe_unused]] argc, [[maybe_unused]] char *argv[]) -> int {
     _configJson["world"]["render_distance"] = 4;
     _configJson["world"]["view_distance"] = 5;
     _configJson["world"]["unload_distance"] = 6;
+    _configJson["world"]["view_direction_bias"] = 0.5f;
+    _configJson["world"]["generation_batch_size"] = 8;
+    _configJson["world"]["region_batch_radius"] = 2;
+    _configJson["world"]["generation_threads"] = 0;
+    _configJson["world"]["upload_budget_ms"] = 2.0;
+    _configJson["world"]["upload_budget_bytes"] = 8 * 1024 * 1024;
+    _configJson["world"]["mesher"] = "bitmask";
+    _configJson["world"]["indexed_meshes"] = true;
+    _configJson["world"]["noise_lattice_xz"] = 1;
+    _configJson["world"]["noise_lattice_y"] = 1;
+    _configJson["world"]["classifier_samples"] = 4;
+    _configJson["world"]["column_cache_capacity"] = 1024;
+    _configJson["world"]["sea_level"] = 0;
+    _configJson["world"]["caves"] = true;
+    _configJson["world"]["decoration"] = true;
+    _configJson["world"]["tree_rarity"] = 61;
+    _configJson["world"]["save_chunks"] = true;
+    _configJson["world"]["save_directory"] = "saves";
+    _configJson["world"]["region_compression_level"] = 1;
+    _configJson["world"]["region_read_mode"] = "mmap";
+    _configJson["world"]["region_save_mode"] = "full";
+    _configJson["world"]["io_write_delay_ms"] = 100;
 
     std::ofstream config_file("config.json");
     config_file << _configJson;
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Cube lib
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "GeneratorPool.hpp"
+#include "chunk_io.hpp"
+#include "chunk_registry.hpp"
+#include "region_file.hpp"
+#include "vector.hpp"
+
+// Headless pregeneration of a box of chunks into the region files of a save, no window.
+// The game loads the chunks of <output>/<seed> instead of generating them, with the same generator settings.
+
+static void print_usage(const char *name) {
+  std::cout << "Usage: " << name << " --seed N --from X Y Z --to X Y Z [options]\n"
+            << "Generate the chunks from..to (inclusive chunk positions) into <output>/<seed>/r.x.y.z.wocr\n"
+            << "Options:\n"
+            << "  --output DIR                 save directory (default: saves)\n"
+            << "  --threads N                  generation threads (default: 0, all hardware threads)\n"
+            << "  --compression N              zlib level of the region files, 0: none (default: 1)\n"
+            << "  --octaves N --lacunarity F --gain F --frequency F --weighted-strength F --multiplier N\n"
+            << "  --noise-lattice XZ Y --classifier-samples N --sea-level N --caves 0|1 --decoration 0|1 --tree-rarity N\n"
+            << "                               generator settings, same defaults as the game\n";
+}
+
+// Chunks of the box in a region, the pieces are generated one after the other
+struct region_piece {
+  benlib::Vector3i begin;
+  benlib::Vector3i size;
+};
+
+static std::vector<region_piece> split_by_region(const benlib::Vector3i &from, const benlib::Vector3i &to) {
+  const benlib::Vector3i first = region_file::region_position(from);
+  const benlib::Vector3i last = region_file::region_position(to);
+  constexpr int32_t region_size = region_file::region_size;
+
+  std::vector<region_piece> pieces;
+  for (int32_t z = first.z; z <= last.z; z++) {
+    for (int32_t y = first.y; y <= last.y; y++) {
+      for (int32_t x = first.x; x <= last.x; x++) {
+        const benlib::Vector3i begin = {std::max(from.x, x * region_size), std::max(from.y, y * region_size), std::max(from.z, z * region_size)};
+        const benlib::Vector3i end = {std::min(to.x, x * region_size + region_size - 1), std::min(to.y, y * region_size + region_size - 1),
+                                      std::min(to.z, z * region_size + region_size - 1)};
+        pieces.push_back({begin, {end.x - begin.x + 1, end.y - begin.y + 1, end.z - begin.z + 1}});
+      }
+    }
+  }
+  return pieces;
+}
+
+static uint64_t directory_size(const std::filesystem::path &directory) {
+  uint64_t size = 0;
+  for (const auto &file : std::filesystem::directory_iterator(directory)) {
+    if (file.is_regular_file()) {
+      size += file.file_size();
+    }
+  }
+  return size;
+}
+
+auto main(int argc, char *argv[]) -> int {
+  std::ios_base::sync_with_stdio(false);
+
+  Generator generator;
+  bool has_seed = false;
+  bool has_from = false;
+  bool has_to = false;
+  benlib::Vector3i from = {0, 0, 0};
+  benlib::Vector3i to = {0, 0, 0};
+  std::filesystem::path output = "saves";
+  uint32_t thread_count = 0;
+  int compression_level = 1;
+  uint32_t lattice_xz = 1;
+  uint32_t lattice_y = 1;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      const std::string_view arg = argv[i];
+      // Values of the current option
+      auto next = [&]() -> std::string {
+        if (i + 1 >= argc) {
+          throw std::invalid_argument(std::string(arg) + " needs a value");
+        }
+        return argv[++i];
+      };
+      auto next_vector = [&]() -> benlib::Vector3i {
+        const int32_t x = std::stoi(next());
+        const int32_t y = std::stoi(next());
+        const int32_t z = std::stoi(next());
+        return {x, y, z};
+      };
+
+      if (arg == "--help" || arg == "-h") {
+        print_usage(argv[0]);
+        return 0;
+      } else if (arg == "--seed") {
+        generator.reseed(static_cast<int32_t>(std::stoll(next())));
+        has_seed = true;
+      } else if (arg == "--from") {
+        from = next_vector();
+        has_from = true;
+      } else if (arg == "--to") {
+        to = next_vector();
+        has_to = true;
+      } else if (arg == "--output") {
+        output = next();
+      } else if (arg == "--threads") {
+        thread_count = static_cast<uint32_t>(std::stoul(next()));
+      } else if (arg == "--compression") {
+        compression_level = std::stoi(next());
+      } else if (arg == "--octaves") {
+        generator.setOctaves(static_cast<uint32_t>(std::stoul(next())));
+      } else if (arg == "--lacunarity") {
+        generator.set_lacunarity(std::stof(next()));
+      } else if (arg == "--gain") {
+        generator.set_gain(std::stof(next()));
+      } else if (arg == "--frequency") {
+        generator.setFrequency(std::stof(next()));
+      } else if (arg == "--weighted-strength") {
+        generator.set_weighted_strength(std::stof(next()));
+      } else if (arg == "--multiplier") {
+        generator.setMultiplier(static_cast<uint32_t>(std::stoul(next())));
+      } else if (arg == "--noise-lattice") {
+        lattice_xz = static_cast<uint32_t>(std::stoul(next()));
+        lattice_y = static_cast<uint32_t>(std::stoul(next()));
+      } else if (arg == "--classifier-samples") {
+        generator.set_classifier_samples(static_cast<uint32_t>(std::stoul(next())));
+      } else if (arg == "--sea-level") {
+        generator.set_sea_level(std::stoi(next()));
+      } else if (arg == "--caves") {
+        generator.set_caves(std::stoi(next()) != 0);
+      } else if (arg == "--decoration") {
+        generator.set_decoration(std::stoi(next()) != 0);
+      } else if (arg == "--tree-rarity") {
+        generator.set_tree_rarity(static_cast<uint32_t>(std::stoul(next())));
+      } else {
+        throw std::invalid_argument("unknown option " + std::string(arg));
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid arguments: " << e.what() << "\n";
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  if (!has_seed || !has_from || !has_to) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  if (!generator.set_noise_lattice(lattice_xz, lattice_y)) {
+    std::cerr << "Noise lattice steps must divide the chunk size, using " << generator.get_noise_lattice_xz() << " " << generator.get_noise_lattice_y() << "\n";
+  }
+  const benlib::Vector3i box_begin = {std::min(from.x, to.x), std::min(from.y, to.y), std::min(from.z, to.z)};
+  const benlib::Vector3i box_end = {std::max(from.x, to.x), std::max(from.y, to.y), std::max(from.z, to.z)};
+
+  // Same directory as the game for this seed, full chunks: nothing is edited yet, a delta save would be empty
+  const std::filesystem::path directory = output / std::to_string(generator.get_seed());
+  auto storage = std::make_shared<region_storage>(directory, compression_level);
+  GeneratorPool pool(generator, thread_count);
+  const std::vector<region_piece> pieces = split_by_region(box_begin, box_end);
+
+  std::cout << "Generating chunks " << box_begin.x << " " << box_begin.y << " " << box_begin.z << " to " << box_end.x << " " << box_end.y << " "
+            << box_end.z << " (" << pieces.size() << " regions) into " << directory.string() << " with " << pool.get_thread_count() << " threads\n";
+
+  const auto start = std::chrono::steady_clock::now();
+  uint64_t generated_chunks = 0;
+  uint64_t redecorated_chunks = 0;
+  uint64_t failed_writes = 0;
+  {
+    // Compression and writes of a region overlap the generation of the next one
+    chunk_io io(storage, std::chrono::milliseconds(0));
+    decoration_store &decorations = generator.get_decoration_store();
+    std::unordered_set<chunk_registry::key_t> written;
+    // Chunks of earlier regions that received tree blocks from a later one
+    std::unordered_set<chunk_registry::key_t> redecorate;
+    std::vector<benlib::Vector3i> redecorate_positions;
+
+    for (const region_piece &piece : pieces) {
+      std::vector<std::unique_ptr<Chunk>> chunks = pool.generate_region(piece.begin, piece.size, true);
+      for (const auto &pos : decorations.take_dirty()) {
+        const chunk_registry::key_t key = chunk_registry::pack(pos);
+        if (written.count(key) != 0 && redecorate.insert(key).second) {
+          redecorate_positions.push_back(pos);
+        }
+      }
+      for (const auto &current_chunk : chunks) {
+        written.insert(chunk_registry::pack(current_chunk->get_position()));
+      }
+      generated_chunks += chunks.size();
+
+      // Bound the chunks waiting for the disk
+      if (io.get_pending_writes() > 2 * region_file::chunk_count) {
+        io.flush();
+      }
+      io.write(std::move(chunks));
+    }
+
+    if (!redecorate_positions.empty()) {
+      std::vector<std::unique_ptr<Chunk>> chunks = io.read(redecorate_positions).get();
+      std::vector<std::unique_ptr<Chunk>> changed_chunks;
+      for (auto &current_chunk : chunks) {
+        if (current_chunk != nullptr && generator.apply_pending_decorations(*current_chunk)) {
+          changed_chunks.push_back(std::move(current_chunk));
+        }
+      }
+      redecorated_chunks = changed_chunks.size();
+      io.write(std::move(changed_chunks));
+    }
+    io.flush();
+    failed_writes = io.get_failed_writes();
+  }
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Generated " << generated_chunks << " chunks in " << seconds << " s: " << static_cast<double>(generated_chunks) / std::max(seconds, 1e-9)
+            << " chunks/s (" << redecorated_chunks << " chunks written again for trees across regions)\n"
+            << "Written " << storage->get_bytes_written() << " bytes (" << storage->get_payload_bytes() << " bytes of chunk payloads), "
+            << (std::filesystem::exists(directory) ? directory_size(directory) : 0) << " bytes on disk\n";
+  if (failed_writes != 0) {
+    std::cerr << failed_writes << " chunks could not be written\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "chunk_io.hpp"
+#include "region_file.hpp"
+
+static constexpr uint32_t bench_seed = 2510586073u;
+
+// Chunks unloaded per call, as the world does when the player moves by a chunk
+static constexpr int32_t batch_size = 64;
+
+static std::filesystem::path bench_directory(const std::string &name) {
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / ("world_of_blocks_chunk_io_bench_" + name);
+  std::filesystem::remove_all(directory);
+  return directory;
+}
+
+static std::vector<std::unique_ptr<Chunk>> make_batch(const std::vector<std::unique_ptr<Chunk>> &samples, const int32_t batch) {
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (int32_t i = 0; i < batch_size; i++) {
+    const Chunk &sample = *samples[static_cast<size_t>(i) % samples.size()];
+    chunks.push_back(std::make_unique<Chunk>(sample.get_storage(), i % 8, batch, i / 8));
+  }
+  return chunks;
+}
+
+static std::vector<std::unique_ptr<Chunk>> make_samples() {
+  Generator generator(bench_seed);
+  std::vector<std::unique_ptr<Chunk>> samples;
+  for (int32_t x = 0; x < 4; x++) {
+    for (int32_t y = -2; y < 2; y++) {
+      samples.push_back(generator.generateChunk(x, y, 0, true));
+    }
+  }
+  return samples;
+}
+
+// Time the caller is blocked saving a batch of unloaded chunks on its own thread
+static void save_batch_sync(benchmark::State &state) {
+  const std::filesystem::path directory = bench_directory("sync");
+  const auto samples = make_samples();
+  region_storage storage(directory);
+
+  int32_t batch = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto chunks = make_batch(samples, batch++ % 16);
+    state.ResumeTiming();
+    storage.save_chunks(chunks);
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+  std::filesystem::remove_all(directory);
+}
+BENCHMARK(save_batch_sync)->Unit(benchmark::kMicrosecond);
+
+// Time the caller is blocked handing the same batches to the I/O thread, rewrites of a chunk within the delay are coalesced
+static void save_batch_async(benchmark::State &state) {
+  const std::filesystem::path directory = bench_directory("async");
+  const auto samples = make_samples();
+  auto storage = std::make_shared<region_storage>(directory);
+  auto io = std::make_unique<chunk_io>(storage, std::chrono::milliseconds(state.range(0)));
+
+  int32_t batch = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto chunks = make_batch(samples, batch++ % 16);
+    state.ResumeTiming();
+    io->write(std::move(chunks));
+  }
+  io->flush();
+  state.counters["coalesced"] = static_cast<double>(io->get_coalesced_writes());
+  state.counters["written"] = static_cast<double>(storage->get_saved_chunks());
+  state.counters["write_p50_us"] = static_cast<double>(io->get_write_latency().quantile_us(0.5));
+  state.counters["write_p99_us"] = static_cast<double>(io->get_write_latency().quantile_us(0.99));
+  state.SetItemsProcessed(state.iterations() * batch_size);
+  io.reset();
+  std::filesystem::remove_all(directory);
+}
+BENCHMARK(save_batch_async)->ArgName("delay_ms")->Arg(0)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
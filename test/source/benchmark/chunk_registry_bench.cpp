@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "chunk_registry.hpp"
+
+// Fill a cube of (2 * radius + 1)^3 chunks, like world::generate_world_thread_func with render_distance = radius
+template <typename Fn> static void for_each_chunk_pos(const int32_t radius, Fn fn) {
+  for (int32_t x = -radius; x <= radius; x++) {
+    for (int32_t y = -radius; y <= radius; y++) {
+      for (int32_t z = -radius; z <= radius; z++) {
+        fn(x, y, z);
+      }
+    }
+  }
+}
+
+static void chunk_list_lookup(benchmark::State &state) {
+  const auto radius = static_cast<int32_t>(state.range(0));
+  std::list<std::unique_ptr<Chunk>> chunks;
+  for_each_chunk_pos(radius, [&](int32_t x, int32_t y, int32_t z) {
+    chunks.push_back(std::make_unique<Chunk>());
+    chunks.back()->set_chuck_pos(x, y, z);
+  });
+
+  for (auto _ : state) {
+    size_t found = 0;
+    for_each_chunk_pos(radius, [&](int32_t x, int32_t y, int32_t z) {
+      auto it = std::find_if(chunks.begin(), chunks.end(), [&](const auto &chunk) {
+        auto chunk_pos = chunk->get_position();
+        return chunk_pos.x == x && chunk_pos.y == y && chunk_pos.z == z;
+      });
+      found += it != chunks.end();
+    });
+    benchmark::DoNotOptimize(found);
+  }
+  state.counters["loaded_chunks"] = static_cast<double>(chunks.size());
+  state.SetItemsProcessed(state.iterations() * chunks.size());
+}
+BENCHMARK(chunk_list_lookup)->Name("chunk_list_lookup")->DenseRange(1, 5, 2)->Unit(benchmark::kMicrosecond);
+
+static void chunk_registry_lookup(benchmark::State &state) {
+  const auto radius = static_cast<int32_t>(state.range(0));
+  chunk_registry chunks;
+  for_each_chunk_pos(radius, [&](int32_t x, int32_t y, int32_t z) {
+    auto chunk = std::make_unique<Chunk>();
+    chunk->set_chuck_pos(x, y, z);
+    chunks.insert(std::move(chunk));
+  });
+
+  for (auto _ : state) {
+    size_t found = 0;
+    for_each_chunk_pos(radius, [&](int32_t x, int32_t y, int32_t z) { found += chunks.contains(x, y, z); });
+    benchmark::DoNotOptimize(found);
+  }
+  state.counters["loaded_chunks"] = static_cast<double>(chunks.size());
+  state.SetItemsProcessed(state.iterations() * chunks.size());
+}
+BENCHMARK(chunk_registry_lookup)->Name("chunk_registry_lookup")->DenseRange(1, 9, 2)->Unit(benchmark::kMicrosecond);
+
+static void chunk_registry_insert_erase(benchmark::State &state) {
+  const auto radius = static_cast<int32_t>(state.range(0));
+
+  for (auto _ : state) {
+    chunk_registry chunks;
+    for_each_chunk_pos(radius, [&](int32_t x, int32_t y, int32_t z) {
+      auto chunk = std::make_unique<Chunk>();
+      chunk->set_chuck_pos(x, y, z);
+      chunks.insert(std::move(chunk));
+    });
+    for_each_chunk_pos(radius, [&](int32_t x, int32_t y, int32_t z) { chunks.erase(x, y, z); });
+    benchmark::DoNotOptimize(chunks);
+  }
+  const auto count = (2 * radius + 1) * (2 * radius + 1) * (2 * radius + 1);
+  state.counters["loaded_chunks"] = static_cast<double>(count);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(chunk_registry_insert_erase)->Name("chunk_registry_insert_erase")->DenseRange(1, 9, 2)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
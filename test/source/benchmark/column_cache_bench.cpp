@@ -0,0 +1,37 @@
+#include <cstdint>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+
+static constexpr uint32_t bench_seed = 2510586073u;
+
+// Chunks stacked in each generated column
+static constexpr int32_t column_height = 8;
+
+// 2D generation of whole chunk columns, state.range(0): column cache capacity (0: disabled)
+static void generate_chunk_columns_2d(benchmark::State &state) {
+  Generator generator(bench_seed);
+  generator.set_column_cache_capacity(static_cast<size_t>(state.range(0)));
+
+  int32_t chunk_x = 0;
+  for (auto _ : state) {
+    for (int32_t chunk_y = 0; chunk_y < column_height; chunk_y++) {
+      auto chunk = generator.generateChunk(chunk_x, chunk_y, 0, false);
+      benchmark::DoNotOptimize(chunk);
+    }
+    chunk_x++;
+  }
+
+  state.counters["hit_rate"] = generator.get_column_cache().hit_rate();
+  state.counters["chunks_per_second"] = benchmark::Counter(static_cast<double>(state.iterations() * column_height), benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(state.iterations() * column_height);
+}
+BENCHMARK(generate_chunk_columns_2d)->Arg(0)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
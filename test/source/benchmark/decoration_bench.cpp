@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+
+static constexpr uint32_t bench_seed = 2510586073u;
+
+// Flat grass ground up to world y 30, trees cross the chunk top and sides
+static terrain_buffer make_flat_buffer(Generator &generator, const int32_t chunk_x) {
+  terrain_buffer buffer;
+  generator.prepare_terrain_buffer(buffer, chunk_x, 0, 0);
+  for (int32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    for (int32_t y = 0; y < static_cast<int32_t>(buffer.size_y); y++) {
+      std::fill_n(buffer.blocks.begin() + math::convert_to_1d<size_t>(0, y, z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z),
+                  Chunk::chunk_size_x, y < 30 ? block_type::stone : block_type::air);
+    }
+  }
+  generator.terrain_surface(buffer);
+  return buffer;
+}
+
+// Decoration of a flat forest chunk: seeding, overflow to the store and pending blocks of the neighbours,
+// state.range(0): tree rarity (one tree every n grass columns)
+static void decorate_forest_chunk(benchmark::State &state) {
+  Generator generator(bench_seed);
+  generator.set_tree_rarity(static_cast<uint32_t>(state.range(0)));
+  const terrain_buffer ground = make_flat_buffer(generator, 0);
+
+  int32_t chunk_x = 0;
+  size_t overflow_blocks = 0;
+  for (auto _ : state) {
+    terrain_buffer buffer = ground;
+    buffer.begin_x = chunk_x * Chunk::chunk_size_x;
+    generator.terrain_decoration(buffer);
+    generator.publish_decorations(buffer);
+    auto chunk = Generator::chunk_from_terrain(buffer, chunk_x, 0, 0);
+    generator.apply_pending_decorations(*chunk);
+    benchmark::DoNotOptimize(chunk);
+    overflow_blocks += buffer.overflow.size();
+    chunk_x++;
+  }
+  state.counters["overflow_blocks"] = static_cast<double>(overflow_blocks) / static_cast<double>(state.iterations());
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(decorate_forest_chunk)->Arg(61)->Arg(8)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+// Whole pipeline on a block of chunks around the ground with dense forests, state.range(0): tree rarity
+static void generate_forest_chunks(benchmark::State &state) {
+  Generator generator(bench_seed);
+  generator.set_tree_rarity(static_cast<uint32_t>(state.range(0)));
+
+  int32_t begin_x = 0;
+  for (auto _ : state) {
+    auto chunks = generator.generateChunks(begin_x, -1, 0, 2, 3, 2, true);
+    benchmark::DoNotOptimize(chunks);
+    begin_x += 2;
+  }
+  state.counters["pending_chunks"] = static_cast<double>(generator.get_decoration_store().size());
+  state.SetItemsProcessed(state.iterations() * 2 * 3 * 2);
+}
+BENCHMARK(generate_forest_chunks)->Arg(61)->Arg(4)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,74 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "GeneratorPool.hpp"
+
+static std::vector<benlib::Vector3i> region_positions(const int32_t size) {
+  std::vector<benlib::Vector3i> positions;
+  positions.reserve(size * size * size);
+  for (int32_t x = 0; x < size; x++) {
+    for (int32_t y = 0; y < size; y++) {
+      for (int32_t z = 0; z < size; z++) {
+        positions.push_back({x, y, z});
+      }
+    }
+  }
+  return positions;
+}
+
+// Baseline: one generator, one thread
+static void generate_region_single(benchmark::State &state) {
+  const auto size = static_cast<int32_t>(state.range(0));
+  const auto positions = region_positions(size);
+  Generator generator(2510586073u);
+
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    chunks.reserve(positions.size());
+    for (const auto &pos : positions) {
+      chunks.push_back(generator.generateChunk(pos.x, pos.y, pos.z, true));
+    }
+    benchmark::DoNotOptimize(chunks);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(generate_region_single)->Name("generate_region_single")->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Worker pool, state.range(1) threads
+static void generate_region_pool(benchmark::State &state) {
+  const auto size = static_cast<int32_t>(state.range(0));
+  const auto thread_count = static_cast<uint32_t>(state.range(1));
+  const auto positions = region_positions(size);
+  Generator generator(2510586073u);
+  GeneratorPool pool(generator, thread_count);
+
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<Chunk>> chunks = pool.generateChunks(positions, true);
+    benchmark::DoNotOptimize(chunks);
+    benchmark::ClobberMemory();
+  }
+  state.counters["threads"] = static_cast<double>(pool.get_thread_count());
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+static void generate_region_pool_args(benchmark::internal::Benchmark *bench) {
+  const auto max_threads = static_cast<int64_t>(std::max(1u, std::thread::hardware_concurrency()));
+  for (int64_t threads = 1; threads <= max_threads; threads *= 2) {
+    bench->Args({4, threads});
+  }
+  if ((max_threads & (max_threads - 1)) != 0) {
+    bench->Args({4, max_threads});
+  }
+}
+BENCHMARK(generate_region_pool)->Name("generate_region_pool")->Apply(generate_region_pool_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,100 @@
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Block.hpp"
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "palette_storage.hpp"
+
+static constexpr uint32_t bench_seed = 2510586073u;
+static constexpr uint32_t size = Chunk::chunk_size_x;
+static constexpr size_t block_count = Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z;
+
+static std::vector<float> make_noise() {
+  Generator generator(bench_seed);
+  std::vector<float> noise(block_count);
+  generator.generate3d_noise(noise.data(), 0, 0, 0, size, size, size);
+  return noise;
+}
+
+// Stage 1: noise grid
+static void stage_noise(benchmark::State &state) {
+  Generator generator(bench_seed);
+  std::vector<float> noise(block_count);
+  for (auto _ : state) {
+    generator.generate3d_noise(noise.data(), 0, 0, 0, size, size, size);
+    benchmark::DoNotOptimize(noise.data());
+  }
+  state.SetItemsProcessed(state.iterations() * block_count);
+}
+BENCHMARK(stage_noise)->Unit(benchmark::kMicrosecond);
+
+// Stage 2 (previous version): double precision heightmap, then blocks written in x/z/y order
+static void stage_blocks_heightmap(benchmark::State &state) {
+  const std::vector<float> noise = make_noise();
+  const uint32_t multiplier = Generator().get_multiplier();
+  for (auto _ : state) {
+    std::vector<uint32_t> heightmap(block_count);
+    for (size_t i = 0; i < block_count; i++) {
+      heightmap[i] = static_cast<uint32_t>((noise[i] + 1.0) * multiplier);
+    }
+    std::vector<Block> blocks(block_count);
+    for (uint32_t x = 0; x < size; x++) {
+      for (uint32_t z = 0; z < size; z++) {
+        for (uint32_t y = 0; y < size; y++) {
+          const size_t index = math::convert_to_1d(x, y, z, size, size, size);
+          if (heightmap[index] > 120) {
+            blocks[index].block_type = block_type::stone;
+          }
+        }
+      }
+    }
+    benchmark::DoNotOptimize(blocks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * block_count);
+}
+BENCHMARK(stage_blocks_heightmap)->Unit(benchmark::kMicrosecond);
+
+// Stage 2: fused float threshold kernel in memory order
+static void stage_blocks_threshold(benchmark::State &state) {
+  const std::vector<float> noise = make_noise();
+  const float noise_threshold = Generator::stone_noise_threshold(Generator().get_multiplier());
+  std::vector<Block> blocks(block_count);
+  for (auto _ : state) {
+    Generator::threshold_blocks(noise.data(), reinterpret_cast<block_type::block_t *>(blocks.data()), block_count, noise_threshold);
+    benchmark::DoNotOptimize(blocks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * block_count);
+}
+BENCHMARK(stage_blocks_threshold)->Unit(benchmark::kMicrosecond);
+
+// Stage 3: chunk block storage
+static void stage_palette(benchmark::State &state) {
+  Generator generator(bench_seed);
+  const std::vector<Block> blocks = generator.generate3d(0, 0, 0, size, size, size);
+  for (auto _ : state) {
+    palette_storage storage(blocks);
+    benchmark::DoNotOptimize(storage);
+  }
+  state.SetItemsProcessed(state.iterations() * block_count);
+}
+BENCHMARK(stage_palette)->Unit(benchmark::kMicrosecond);
+
+// All stages (classifier disabled)
+static void generate_chunk(benchmark::State &state) {
+  Generator generator(bench_seed);
+  generator.set_classifier_samples(0);
+  for (auto _ : state) {
+    auto chunk = generator.generateChunk(0, 0, 0, true);
+    benchmark::DoNotOptimize(chunk);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(generate_chunk)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
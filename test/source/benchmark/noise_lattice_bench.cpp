@@ -0,0 +1,108 @@
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+
+static constexpr uint32_t bench_seed = 2510586073u;
+
+// Chunks compared against full resolution sampling: a column of chunks around the surface
+static constexpr int32_t diff_chunk_y_min = -2;
+static constexpr int32_t diff_chunk_y_max = 2;
+
+struct terrain_diff {
+  // Blocks with a different type than full resolution
+  double block_diff_percent = 0.0;
+  // Mean absolute difference of the highest solid block of each column (in blocks)
+  double surface_deviation = 0.0;
+};
+
+// Highest solid y of each (x, z) column of the chunk column, -1 if none
+static std::vector<int32_t> surface_heights(const std::vector<std::unique_ptr<Chunk>> &chunk_column) {
+  std::vector<int32_t> heights(Chunk::chunk_size_x * Chunk::chunk_size_z, -1);
+  for (size_t c = 0; c < chunk_column.size(); c++) {
+    for (int z = 0; z < Chunk::chunk_size_z; z++) {
+      for (int y = 0; y < Chunk::chunk_size_y; y++) {
+        for (int x = 0; x < Chunk::chunk_size_x; x++) {
+          if (chunk_column[c]->get_block(x, y, z).block_type != block_type::air) {
+            heights[z * Chunk::chunk_size_x + x] = static_cast<int32_t>(c) * Chunk::chunk_size_y + y;
+          }
+        }
+      }
+    }
+  }
+  return heights;
+}
+
+static std::vector<std::unique_ptr<Chunk>> generate_chunk_column(Generator &generator) {
+  std::vector<std::unique_ptr<Chunk>> chunk_column;
+  for (int32_t chunk_y = diff_chunk_y_min; chunk_y <= diff_chunk_y_max; chunk_y++) {
+    chunk_column.push_back(generator.generateChunk(0, chunk_y, 0, true));
+  }
+  return chunk_column;
+}
+
+static terrain_diff compare_to_full_resolution(const uint32_t step_xz, const uint32_t step_y) {
+  Generator full_generator(bench_seed);
+  Generator coarse_generator(bench_seed);
+  coarse_generator.set_noise_lattice(step_xz, step_y);
+
+  const auto full_column = generate_chunk_column(full_generator);
+  const auto coarse_column = generate_chunk_column(coarse_generator);
+
+  size_t diff_blocks = 0;
+  size_t total_blocks = 0;
+  for (size_t c = 0; c < full_column.size(); c++) {
+    const std::vector<Block> full_blocks = full_column[c]->get_blocks();
+    const std::vector<Block> coarse_blocks = coarse_column[c]->get_blocks();
+    for (size_t i = 0; i < full_blocks.size(); i++) {
+      diff_blocks += full_blocks[i].block_type != coarse_blocks[i].block_type;
+    }
+    total_blocks += full_blocks.size();
+  }
+
+  const std::vector<int32_t> full_heights = surface_heights(full_column);
+  const std::vector<int32_t> coarse_heights = surface_heights(coarse_column);
+  double deviation = 0.0;
+  for (size_t i = 0; i < full_heights.size(); i++) {
+    deviation += std::abs(full_heights[i] - coarse_heights[i]);
+  }
+
+  return {100.0 * static_cast<double>(diff_blocks) / static_cast<double>(total_blocks), deviation / static_cast<double>(full_heights.size())};
+}
+
+// state.range(0): lattice step on x/z, state.range(1): lattice step on y (1, 1: full resolution)
+static void generate_chunk_lattice(benchmark::State &state) {
+  const uint32_t step_xz = static_cast<uint32_t>(state.range(0));
+  const uint32_t step_y = static_cast<uint32_t>(state.range(1));
+
+  Generator generator(bench_seed);
+  generator.set_noise_lattice(step_xz, step_y);
+
+  int32_t chunk_x = 0;
+  for (auto _ : state) {
+    auto chunk = generator.generateChunk(chunk_x++, 0, 0, true);
+    benchmark::DoNotOptimize(chunk);
+  }
+
+  const terrain_diff diff = compare_to_full_resolution(step_xz, step_y);
+  state.counters["block_diff_percent"] = diff.block_diff_percent;
+  state.counters["surface_deviation"] = diff.surface_deviation;
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(generate_chunk_lattice)
+    ->Args({1, 1})
+    ->Args({2, 2})
+    ->Args({4, 4})
+    ->Args({4, 8})
+    ->Args({8, 8})
+    ->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,127 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Block.hpp"
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "palette_storage.hpp"
+
+static constexpr size_t block_count = Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z;
+
+// state.range(0): chunk y (0: surface, -1: underground, 1: sky)
+static std::vector<Block> make_blocks(const int64_t chunk_y) {
+  Generator generator(2510586073u);
+  return generator.generateChunk(0, static_cast<int32_t>(chunk_y), 0, true)->get_blocks();
+}
+
+static std::vector<size_t> make_random_indices() {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> dis(0, block_count - 1);
+  std::vector<size_t> indices(4096);
+  for (auto &index : indices) {
+    index = dis(gen);
+  }
+  return indices;
+}
+
+static void flat_sequential(benchmark::State &state) {
+  const std::vector<Block> blocks = make_blocks(state.range(0));
+  for (auto _ : state) {
+    size_t solid = 0;
+    for (const auto &block : blocks) {
+      solid += block.block_type != block_type::air;
+    }
+    benchmark::DoNotOptimize(solid);
+  }
+  state.counters["bytes_per_chunk"] = static_cast<double>(blocks.capacity() * sizeof(Block));
+  state.SetItemsProcessed(state.iterations() * block_count);
+}
+BENCHMARK(flat_sequential)->DenseRange(-1, 1);
+
+static void palette_sequential(benchmark::State &state) {
+  const palette_storage storage(make_blocks(state.range(0)));
+  for (auto _ : state) {
+    size_t solid = 0;
+    for (size_t i = 0; i < block_count; i++) {
+      solid += storage.get(i) != block_type::air;
+    }
+    benchmark::DoNotOptimize(solid);
+  }
+  state.counters["bytes_per_chunk"] = static_cast<double>(storage.memory_bytes());
+  state.counters["bits_per_block"] = storage.bits_per_block();
+  state.SetItemsProcessed(state.iterations() * block_count);
+}
+BENCHMARK(palette_sequential)->DenseRange(-1, 1);
+
+static void palette_unpack(benchmark::State &state) {
+  const palette_storage storage(make_blocks(state.range(0)));
+  std::vector<block_type::block_t> unpacked(block_count);
+  for (auto _ : state) {
+    storage.unpack(unpacked.data());
+    benchmark::DoNotOptimize(unpacked.data());
+  }
+  state.SetItemsProcessed(state.iterations() * block_count);
+}
+BENCHMARK(palette_unpack)->DenseRange(-1, 1);
+
+static void flat_random(benchmark::State &state) {
+  const std::vector<Block> blocks = make_blocks(state.range(0));
+  const std::vector<size_t> indices = make_random_indices();
+  for (auto _ : state) {
+    size_t solid = 0;
+    for (const size_t index : indices) {
+      solid += blocks[index].block_type != block_type::air;
+    }
+    benchmark::DoNotOptimize(solid);
+  }
+  state.SetItemsProcessed(state.iterations() * indices.size());
+}
+BENCHMARK(flat_random)->DenseRange(-1, 1);
+
+static void palette_random(benchmark::State &state) {
+  const palette_storage storage(make_blocks(state.range(0)));
+  const std::vector<size_t> indices = make_random_indices();
+  for (auto _ : state) {
+    size_t solid = 0;
+    for (const size_t index : indices) {
+      solid += storage.get(index) != block_type::air;
+    }
+    benchmark::DoNotOptimize(solid);
+  }
+  state.SetItemsProcessed(state.iterations() * indices.size());
+}
+BENCHMARK(palette_random)->DenseRange(-1, 1);
+
+static void flat_random_set(benchmark::State &state) {
+  std::vector<Block> blocks = make_blocks(state.range(0));
+  const std::vector<size_t> indices = make_random_indices();
+  for (auto _ : state) {
+    for (const size_t index : indices) {
+      blocks[index].block_type = block_type::stone;
+    }
+    benchmark::DoNotOptimize(blocks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * indices.size());
+}
+BENCHMARK(flat_random_set)->DenseRange(-1, 1);
+
+static void palette_random_set(benchmark::State &state) {
+  palette_storage storage(make_blocks(state.range(0)));
+  const std::vector<size_t> indices = make_random_indices();
+  for (auto _ : state) {
+    for (const size_t index : indices) {
+      storage.set(index, block_type::stone);
+    }
+    benchmark::DoNotOptimize(storage);
+  }
+  state.SetItemsProcessed(state.iterations() * indices.size());
+}
+BENCHMARK(palette_random_set)->DenseRange(-1, 1);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,170 @@
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "region_file.hpp"
+
+static constexpr uint32_t bench_seed = 2510586073u;
+
+// Chunks per axis of the saved area
+static constexpr int32_t area_size = 4;
+
+static std::filesystem::path bench_directory(const int compression_level) {
+  return std::filesystem::temp_directory_path() / ("world_of_blocks_region_bench_" + std::to_string(compression_level));
+}
+
+static std::vector<benlib::Vector3i> area_positions() {
+  std::vector<benlib::Vector3i> positions;
+  for (int32_t z = 0; z < area_size; z++) {
+    for (int32_t y = -area_size / 2; y < area_size / 2; y++) {
+      for (int32_t x = 0; x < area_size; x++) {
+        positions.push_back({x, y, z});
+      }
+    }
+  }
+  return positions;
+}
+
+// Generate the area and save it, return the bytes on disk
+static size_t save_area(const int compression_level) {
+  const std::filesystem::path directory = bench_directory(compression_level);
+  std::filesystem::remove_all(directory);
+  Generator generator(bench_seed);
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (const auto &pos : area_positions()) {
+    chunks.push_back(generator.generateChunk(pos.x, pos.y, pos.z, true));
+  }
+  region_storage storage(directory, compression_level);
+  storage.save_chunks(chunks);
+
+  size_t bytes = 0;
+  for (const auto &file : std::filesystem::directory_iterator(directory)) {
+    bytes += file.file_size();
+  }
+  return bytes;
+}
+
+// Regenerate each chunk of the area from noise
+static void regenerate_chunk(benchmark::State &state) {
+  Generator generator(bench_seed);
+  const std::vector<benlib::Vector3i> positions = area_positions();
+
+  size_t i = 0;
+  for (auto _ : state) {
+    const benlib::Vector3i &pos = positions[i++ % positions.size()];
+    auto chunk = generator.generateChunk(pos.x, pos.y, pos.z, true);
+    benchmark::DoNotOptimize(chunk);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(regenerate_chunk)->Unit(benchmark::kMicrosecond);
+
+// Load each chunk of the area from its region file, state.range(0): zlib level (0: raw payloads)
+static void load_chunk(benchmark::State &state) {
+  const int compression_level = static_cast<int>(state.range(0));
+  const size_t bytes = save_area(compression_level);
+  region_storage storage(bench_directory(compression_level), compression_level);
+  const std::vector<benlib::Vector3i> positions = area_positions();
+
+  size_t i = 0;
+  for (auto _ : state) {
+    auto chunk = storage.load_chunk(positions[i++ % positions.size()]);
+    benchmark::DoNotOptimize(chunk);
+  }
+  state.counters["bytes_per_chunk"] = static_cast<double>(bytes) / static_cast<double>(positions.size());
+  state.SetItemsProcessed(state.iterations());
+  std::filesystem::remove_all(bench_directory(compression_level));
+}
+BENCHMARK(load_chunk)->Arg(0)->Arg(1)->Arg(6)->Unit(benchmark::kMicrosecond);
+
+// Save the whole area in one batch, state.range(0): zlib level
+static void save_chunks(benchmark::State &state) {
+  const int compression_level = static_cast<int>(state.range(0));
+  const std::filesystem::path directory = bench_directory(compression_level);
+  std::filesystem::remove_all(directory);
+  Generator generator(bench_seed);
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (const auto &pos : area_positions()) {
+    chunks.push_back(generator.generateChunk(pos.x, pos.y, pos.z, true));
+  }
+  region_storage storage(directory, compression_level);
+
+  for (auto _ : state) {
+    storage.save_chunks(chunks);
+  }
+  state.counters["chunks_per_second"] = benchmark::Counter(static_cast<double>(state.iterations() * chunks.size()), benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(chunks.size()));
+  std::filesystem::remove_all(directory);
+}
+BENCHMARK(save_chunks)->Arg(0)->Arg(1)->Arg(6)->Unit(benchmark::kMillisecond);
+
+// Generated area with edits_per_chunk blocks changed in every chunk
+static std::vector<std::unique_ptr<Chunk>> edited_area(Generator &generator, const int64_t edits_per_chunk) {
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (const auto &pos : area_positions()) {
+    chunks.push_back(generator.generate_baseline_chunk(pos.x, pos.y, pos.z));
+    for (int64_t i = 0; i < edits_per_chunk; i++) {
+      const int64_t index = (i * 7919) % (Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z);
+      chunks.back()->set_block(static_cast<int>(index % Chunk::chunk_size_x), static_cast<int>((index / Chunk::chunk_size_x) % Chunk::chunk_size_y),
+                               static_cast<int>(index / (Chunk::chunk_size_x * Chunk::chunk_size_y)), Block(block_type::wood));
+    }
+  }
+  return chunks;
+}
+
+// Save edited chunks, state.range(0): save mode (0: full, 1: delta), state.range(1): edits per chunk.
+// bytes_per_chunk: payload bytes on disk per edited chunk (zlib level 1)
+static void save_edited_chunks(benchmark::State &state) {
+  const auto save_mode = static_cast<region_save_mode>(state.range(0));
+  const std::filesystem::path directory = bench_directory(100 + static_cast<int>(state.range(0)));
+  std::filesystem::remove_all(directory);
+  auto generator = std::make_shared<Generator>(bench_seed);
+  const std::vector<std::unique_ptr<Chunk>> chunks = edited_area(*generator, state.range(1));
+
+  region_storage storage(directory, 1);
+  storage.set_save_mode(save_mode, [generator](const benlib::Vector3i &pos) { return generator->generate_baseline_chunk(pos.x, pos.y, pos.z); });
+  for (auto _ : state) {
+    storage.save_chunks(chunks);
+  }
+  state.counters["bytes_per_chunk"] = static_cast<double>(storage.get_payload_bytes()) / static_cast<double>(storage.get_saved_chunks());
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(chunks.size()));
+  std::filesystem::remove_all(directory);
+}
+BENCHMARK(save_edited_chunks)->ArgNames({"delta", "edits"})->ArgsProduct({{0, 1}, {1, 64, 1024}})->Unit(benchmark::kMillisecond);
+
+// Load edited chunks, delta payloads regenerate the chunk first, state.range(0): save mode (0: full, 1: delta)
+static void load_edited_chunk(benchmark::State &state) {
+  const auto save_mode = static_cast<region_save_mode>(state.range(0));
+  const std::filesystem::path directory = bench_directory(100 + static_cast<int>(state.range(0)));
+  std::filesystem::remove_all(directory);
+  auto generator = std::make_shared<Generator>(bench_seed);
+  const chunk_baseline_fn baseline = [generator](const benlib::Vector3i &pos) { return generator->generate_baseline_chunk(pos.x, pos.y, pos.z); };
+  const std::vector<std::unique_ptr<Chunk>> chunks = edited_area(*generator, 64);
+  {
+    region_storage storage(directory, 1);
+    storage.set_save_mode(save_mode, baseline);
+    storage.save_chunks(chunks);
+  }
+
+  region_storage storage(directory, 1);
+  storage.set_save_mode(save_mode, baseline);
+  const std::vector<benlib::Vector3i> positions = area_positions();
+  size_t i = 0;
+  for (auto _ : state) {
+    auto chunk = storage.load_chunk(positions[i++ % positions.size()]);
+    benchmark::DoNotOptimize(chunk);
+  }
+  state.SetItemsProcessed(state.iterations());
+  std::filesystem::remove_all(directory);
+}
+BENCHMARK(load_edited_chunk)->ArgNames({"delta"})->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,54 @@
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+
+static constexpr uint32_t bench_seed = 2510586073u;
+
+// Chunks around the surface, so most of them are mixed and need the noise grid
+static constexpr int32_t begin_chunk_y = -1;
+
+// Baseline: one generateChunk (one noise grid call) per chunk, state.range(0): region size in chunks per axis
+static void generate_region_per_chunk(benchmark::State &state) {
+  const auto size = static_cast<int32_t>(state.range(0));
+  Generator generator(bench_seed);
+
+  int32_t begin_x = 0;
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    for (int32_t z = 0; z < size; z++) {
+      for (int32_t y = 0; y < size; y++) {
+        for (int32_t x = 0; x < size; x++) {
+          chunks.push_back(generator.generateChunk(begin_x + x, begin_chunk_y + y, z, true));
+        }
+      }
+    }
+    benchmark::DoNotOptimize(chunks);
+    begin_x += size;
+  }
+  state.SetItemsProcessed(state.iterations() * size * size * size);
+}
+BENCHMARK(generate_region_per_chunk)->Arg(2)->Arg(3)->Unit(benchmark::kMillisecond);
+
+// One noise grid call for the whole region
+static void generate_region_batched(benchmark::State &state) {
+  const auto size = static_cast<int32_t>(state.range(0));
+  Generator generator(bench_seed);
+
+  int32_t begin_x = 0;
+  for (auto _ : state) {
+    auto chunks = generator.generate_region(begin_x, begin_chunk_y, 0, size, size, size, true);
+    benchmark::DoNotOptimize(chunks);
+    begin_x += size;
+  }
+  state.SetItemsProcessed(state.iterations() * size * size * size);
+}
+BENCHMARK(generate_region_batched)->Arg(2)->Arg(3)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "region_file.hpp"
+
+static constexpr uint32_t bench_seed = 2510586073u;
+
+// Reloaded area: one whole region
+static constexpr int32_t area_size = region_file::region_size;
+
+static std::filesystem::path bench_directory(const int compression_level) {
+  return std::filesystem::temp_directory_path() / ("world_of_blocks_region_read_bench_" + std::to_string(compression_level));
+}
+
+// Save the area once per compression level, chunks of a few generated columns repeated over the area
+static void save_area(const int compression_level) {
+  const std::filesystem::path directory = bench_directory(compression_level);
+  if (std::filesystem::exists(directory)) {
+    return;
+  }
+  Generator generator(bench_seed);
+  std::vector<std::unique_ptr<Chunk>> samples;
+  for (int32_t x = 0; x < 4; x++) {
+    for (int32_t y = -2; y < 2; y++) {
+      samples.push_back(generator.generateChunk(x, y, 0, true));
+    }
+  }
+
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (int32_t z = 0; z < area_size; z++) {
+    for (int32_t y = 0; y < area_size; y++) {
+      for (int32_t x = 0; x < area_size; x++) {
+        const Chunk &sample = *samples[static_cast<size_t>(x + y * 3 + z * 7) % samples.size()];
+        chunks.push_back(std::make_unique<Chunk>(sample.get_storage(), x, y, z));
+      }
+    }
+  }
+  region_storage(directory, compression_level).save_chunks(chunks);
+}
+
+// Evict the region files from the page cache, the next reads come from the disk
+static void drop_page_cache(const std::filesystem::path &directory) {
+  for (const auto &file : std::filesystem::directory_iterator(directory)) {
+    const int fd = ::open(file.path().c_str(), O_RDONLY);
+    if (fd < 0) {
+      continue;
+    }
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+}
+
+// Reload the whole area with a new storage (files opened and mapped again),
+// state.range(0): read mode (0: buffered, 1: mmap), state.range(1): zlib level (0: raw payloads), state.range(2): cold page cache
+static void reload_region(benchmark::State &state) {
+  const auto read_mode = static_cast<region_read_mode>(state.range(0));
+  const int compression_level = static_cast<int>(state.range(1));
+  const bool cold = state.range(2) != 0;
+  save_area(compression_level);
+  const std::filesystem::path directory = bench_directory(compression_level);
+
+  std::vector<benlib::Vector3i> positions;
+  for (int32_t z = 0; z < area_size; z++) {
+    for (int32_t y = 0; y < area_size; y++) {
+      for (int32_t x = 0; x < area_size; x++) {
+        positions.push_back({x, y, z});
+      }
+    }
+  }
+
+  for (auto _ : state) {
+    if (cold) {
+      state.PauseTiming();
+      drop_page_cache(directory);
+      state.ResumeTiming();
+    }
+    region_storage storage(directory, compression_level, read_mode);
+    auto chunks = storage.load_chunks(positions);
+    benchmark::DoNotOptimize(chunks);
+  }
+  state.counters["chunks_per_second"] = benchmark::Counter(static_cast<double>(state.iterations() * positions.size()), benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(positions.size()));
+}
+BENCHMARK(reload_region)
+    ->ArgNames({"mmap", "zlib", "cold"})
+    ->ArgsProduct({{0, 1}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Read every block of the area through views of the mapped raw payloads, without any chunk copy
+static void view_region(benchmark::State &state) {
+  save_area(0);
+  region_file region(bench_directory(0) / "r.0.0.0.wocr", region_read_mode::mmap);
+
+  for (auto _ : state) {
+    uint64_t solid_blocks = 0;
+    chunk_view view;
+    for (int32_t z = 0; z < area_size; z++) {
+      for (int32_t y = 0; y < area_size; y++) {
+        for (int32_t x = 0; x < area_size; x++) {
+          if (!region.view_chunk({x, y, z}, view)) {
+            continue;
+          }
+          for (size_t i = 0; i < view.count; i += 64) {
+            solid_blocks += view.get(i) != block_type::air ? 1 : 0;
+          }
+        }
+      }
+    }
+    benchmark::DoNotOptimize(solid_blocks);
+  }
+  state.SetItemsProcessed(state.iterations() * area_size * area_size * area_size);
+}
+BENCHMARK(view_region)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  for (const int compression_level : {0, 1}) {
+    std::filesystem::remove_all(bench_directory(compression_level));
+  }
+}
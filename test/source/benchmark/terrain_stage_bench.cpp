@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+
+static constexpr uint32_t bench_seed = 2510586073u;
+// Chunk crossing the sea level, so every stage has work to do
+static constexpr int32_t bench_sea_level = Chunk::chunk_size_y / 2;
+
+static Generator make_generator() {
+  Generator generator(bench_seed);
+  generator.set_sea_level(bench_sea_level);
+  return generator;
+}
+
+// Buffer of chunk (0, 0, 0) after the stages before last_stage
+static terrain_buffer make_buffer(Generator &generator, const terrain_stage last_stage) {
+  terrain_buffer buffer;
+  generator.prepare_terrain_buffer(buffer, 0, 0, 0);
+  using stage_fn = void (*)(Generator &, terrain_buffer &);
+  static constexpr stage_fn stages[terrain_stage_count] = {
+      [](Generator &g, terrain_buffer &b) { g.terrain_density(b); }, [](Generator &g, terrain_buffer &b) { g.terrain_surface(b); },
+      [](Generator &g, terrain_buffer &b) { g.terrain_water(b); },   [](Generator &g, terrain_buffer &b) { g.terrain_caves(b); },
+      [](Generator &g, terrain_buffer &b) { g.terrain_decoration(b); }};
+  for (size_t stage = 0; stage < static_cast<size_t>(last_stage); stage++) {
+    stages[stage](generator, buffer);
+  }
+  return buffer;
+}
+
+// Each stage alone, on the output of the previous stages (stages after density are idempotent)
+static void stage_density(benchmark::State &state) {
+  Generator generator = make_generator();
+  terrain_buffer buffer = make_buffer(generator, terrain_stage::density);
+  for (auto _ : state) {
+    generator.terrain_density(buffer);
+    benchmark::DoNotOptimize(buffer.blocks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * buffer.blocks.size());
+}
+BENCHMARK(stage_density)->Unit(benchmark::kMicrosecond);
+
+static void stage_surface(benchmark::State &state) {
+  Generator generator = make_generator();
+  terrain_buffer buffer = make_buffer(generator, terrain_stage::surface);
+  for (auto _ : state) {
+    generator.terrain_surface(buffer);
+    benchmark::DoNotOptimize(buffer.blocks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * buffer.blocks.size());
+}
+BENCHMARK(stage_surface)->Unit(benchmark::kMicrosecond);
+
+static void stage_water(benchmark::State &state) {
+  Generator generator = make_generator();
+  terrain_buffer buffer = make_buffer(generator, terrain_stage::water);
+  for (auto _ : state) {
+    generator.terrain_water(buffer);
+    benchmark::DoNotOptimize(buffer.blocks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * buffer.blocks.size());
+}
+BENCHMARK(stage_water)->Unit(benchmark::kMicrosecond);
+
+static void stage_caves(benchmark::State &state) {
+  Generator generator = make_generator();
+  terrain_buffer buffer = make_buffer(generator, terrain_stage::caves);
+  for (auto _ : state) {
+    generator.terrain_caves(buffer);
+    benchmark::DoNotOptimize(buffer.blocks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * buffer.blocks.size());
+}
+BENCHMARK(stage_caves)->Unit(benchmark::kMicrosecond);
+
+static void stage_decoration(benchmark::State &state) {
+  Generator generator = make_generator();
+  terrain_buffer buffer = make_buffer(generator, terrain_stage::decoration);
+  for (auto _ : state) {
+    generator.terrain_decoration(buffer);
+    benchmark::DoNotOptimize(buffer.blocks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * buffer.blocks.size());
+}
+BENCHMARK(stage_decoration)->Unit(benchmark::kMicrosecond);
+
+// Whole pipeline over a column of chunks, with the per-stage time reported by the generator (us per chunk)
+static void generate_chunk_pipeline(benchmark::State &state) {
+  Generator generator = make_generator();
+  int32_t chunk_x = 0;
+  for (auto _ : state) {
+    for (int32_t chunk_y = -1; chunk_y <= 1; chunk_y++) {
+      auto chunk = generator.generateChunk(chunk_x, chunk_y, 0, true);
+      benchmark::DoNotOptimize(chunk);
+    }
+    chunk_x++;
+  }
+
+  const terrain_stage_times times = generator.get_stage_times();
+  for (size_t stage = 0; stage < terrain_stage_count; stage++) {
+    state.counters[std::string(Generator::get_stage_name(static_cast<terrain_stage>(stage))) + "_us"] =
+        static_cast<double>(times.nanoseconds[stage]) / 1000.0 / static_cast<double>(std::max<uint64_t>(times.chunks, 1));
+  }
+  state.SetItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(generate_chunk_pipeline)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,159 @@
+#include <bit>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "world_model.hpp"
+
+static constexpr uint32_t bench_seeds[] = {2510586073u, 251058607u, 404u, 1337u};
+
+// state.range(0): seed index, state.range(1): chunk y (surface around 0)
+template <mesher_type Mesher> static void mesh_chunk(benchmark::State &state) {
+  Generator generator(bench_seeds[state.range(0)]);
+  std::unique_ptr<Chunk> chunk = generator.generateChunk(0, static_cast<int32_t>(state.range(1)), 0, true);
+  world_model world_md = world_model();
+  world_md.mesher = Mesher;
+
+  int vertex_count = 0;
+  int triangle_count = 0;
+  for (auto _ : state) {
+    Mesh mesh = world_md.build_chunk_mesh(*chunk);
+    vertex_count = mesh.vertexCount;
+    triangle_count = mesh.triangleCount;
+    benchmark::DoNotOptimize(mesh);
+    state.PauseTiming();
+    UnloadMesh(mesh);
+    state.ResumeTiming();
+  }
+  state.counters["vertices"] = vertex_count;
+  state.counters["triangles"] = triangle_count;
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void mesh_chunk_args(benchmark::internal::Benchmark *bench) {
+  for (int64_t seed = 0; seed < static_cast<int64_t>(std::size(bench_seeds)); seed++) {
+    for (int64_t chunk_y = -1; chunk_y <= 1; chunk_y++) {
+      bench->Args({seed, chunk_y});
+    }
+  }
+}
+
+BENCHMARK(mesh_chunk<mesher_type::naive>)->Name("mesh_chunk_naive")->Apply(mesh_chunk_args)->Unit(benchmark::kMicrosecond);
+BENCHMARK(mesh_chunk<mesher_type::greedy>)->Name("mesh_chunk_greedy")->Apply(mesh_chunk_args)->Unit(benchmark::kMicrosecond);
+BENCHMARK(mesh_chunk<mesher_type::single_pass>)->Name("mesh_chunk_single_pass")->Apply(mesh_chunk_args)->Unit(benchmark::kMicrosecond);
+BENCHMARK(mesh_chunk<mesher_type::bitmask>)->Name("mesh_chunk_bitmask")->Apply(mesh_chunk_args)->Unit(benchmark::kMicrosecond);
+
+enum chunk_kind : int64_t { dense = 0, sparse = 1, surface = 2 };
+
+static std::unique_ptr<Chunk> make_chunk(const int64_t kind) {
+  constexpr size_t block_count = Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z;
+
+  switch (kind) {
+  case dense:
+    return std::make_unique<Chunk>(std::vector<Block>(block_count, Block(block_type::stone)), 0, 0, 0);
+  case sparse: {
+    // ~10% of random solid blocks, mostly isolated: worst case for faces per block
+    std::mt19937 gen(42);
+    std::bernoulli_distribution dis(0.1);
+    std::vector<Block> blocks(block_count);
+    for (auto &block : blocks) {
+      block.block_type = dis(gen) ? block_type::stone : block_type::air;
+    }
+    return std::make_unique<Chunk>(std::move(blocks), 0, 0, 0);
+  }
+  case surface:
+  default: {
+    Generator generator(bench_seeds[0]);
+    return generator.generateChunk(0, 0, 0, true);
+  }
+  }
+}
+
+// state.range(0): chunk_kind
+static void mesh_chunk_kind(benchmark::State &state, const mesher_type mesher) {
+  std::unique_ptr<Chunk> chunk = make_chunk(state.range(0));
+  world_model world_md = world_model();
+  world_md.mesher = mesher;
+
+  int triangle_count = 0;
+  for (auto _ : state) {
+    Mesh mesh = world_md.build_chunk_mesh(*chunk);
+    triangle_count = mesh.triangleCount;
+    benchmark::DoNotOptimize(mesh);
+    state.PauseTiming();
+    UnloadMesh(mesh);
+    state.ResumeTiming();
+  }
+  state.counters["triangles"] = triangle_count;
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(mesh_chunk_kind, naive, mesher_type::naive)->DenseRange(dense, surface)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(mesh_chunk_kind, single_pass, mesher_type::single_pass)->DenseRange(dense, surface)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(mesh_chunk_kind, bitmask, mesher_type::bitmask)->DenseRange(dense, surface)->Unit(benchmark::kMicrosecond);
+
+// Face culling only: count visible faces
+static void count_faces_naive(benchmark::State &state) {
+  std::unique_ptr<Chunk> chunk = make_chunk(state.range(0));
+  world_model world_md = world_model();
+
+  for (auto _ : state) {
+    int faces_count = world_md.chunk_face_count(*chunk);
+    benchmark::DoNotOptimize(faces_count);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(count_faces_naive)->Name("count_faces_naive")->DenseRange(dense, surface)->Unit(benchmark::kMicrosecond);
+
+static void count_faces_bitmask(benchmark::State &state) {
+  std::unique_ptr<Chunk> chunk = make_chunk(state.range(0));
+
+  for (auto _ : state) {
+    const chunk_occupancy occupancy = chunk_occupancy::build(*chunk);
+    size_t faces_count = 0;
+    for (int x = 0; x < Chunk::chunk_size_x; x++) {
+      for (int y = 0; y < Chunk::chunk_size_y; y++) {
+        uint32_t faces[6];
+        occupancy.row_faces(x, y, faces);
+        for (auto face : faces) {
+          faces_count += static_cast<size_t>(std::popcount(face));
+        }
+      }
+    }
+    benchmark::DoNotOptimize(faces_count);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(count_faces_bitmask)->Name("count_faces_bitmask")->DenseRange(dense, surface)->Unit(benchmark::kMicrosecond);
+
+// Bytes sent to the GPU per chunk, state.range(0): chunk_kind
+static void mesh_upload_bytes(benchmark::State &state, const mesher_type mesher, const bool indexed) {
+  std::unique_ptr<Chunk> chunk = make_chunk(state.range(0));
+  world_model world_md = world_model();
+  world_md.mesher = mesher;
+  world_md.indexed_meshes = indexed;
+
+  size_t upload_bytes = 0;
+  for (auto _ : state) {
+    Mesh mesh = world_md.build_chunk_mesh(*chunk);
+    upload_bytes = world_model::mesh_size_bytes(mesh);
+    benchmark::DoNotOptimize(mesh);
+    state.PauseTiming();
+    UnloadMesh(mesh);
+    state.ResumeTiming();
+  }
+  state.counters["upload_bytes"] = static_cast<double>(upload_bytes);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * upload_bytes));
+}
+BENCHMARK_CAPTURE(mesh_upload_bytes, naive_flat, mesher_type::naive, false)->DenseRange(dense, surface)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(mesh_upload_bytes, naive_indexed, mesher_type::naive, true)->DenseRange(dense, surface)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(mesh_upload_bytes, bitmask_flat, mesher_type::bitmask, false)->DenseRange(dense, surface)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(mesh_upload_bytes, bitmask_indexed, mesher_type::bitmask, true)->DenseRange(dense, surface)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,139 @@
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Chunk.hpp"
+#include "chunk_io.hpp"
+#include "region_file.hpp"
+
+#include "gtest/gtest.h"
+
+// Empty directory for the test region files
+static std::filesystem::path test_directory(const std::string &name) {
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / ("world_of_blocks_chunk_io_" + name);
+  std::filesystem::remove_all(directory);
+  return directory;
+}
+
+static std::unique_ptr<Chunk> make_chunk(const benlib::Vector3i &pos, const block_type::block_t type) {
+  auto current_chunk = std::make_unique<Chunk>(Block(block_type::air), pos.x, pos.y, pos.z);
+  current_chunk->set_block(1, 2, 3, Block(type));
+  return current_chunk;
+}
+
+TEST(latency_histogram, quantiles) {
+  latency_histogram histogram;
+  EXPECT_EQ(histogram.quantile_us(0.5), 0);
+
+  for (int i = 0; i < 99; i++) {
+    histogram.add(10);
+  }
+  histogram.add(5000);
+  EXPECT_EQ(histogram.count, 100);
+  EXPECT_EQ(histogram.quantile_us(0.5), 16);
+  EXPECT_EQ(histogram.quantile_us(0.98), 16);
+  EXPECT_EQ(histogram.quantile_us(1.0), 8192);
+  EXPECT_DOUBLE_EQ(histogram.mean_us(), (99.0 * 10.0 + 5000.0) / 100.0);
+}
+
+TEST(chunk_io, writes_are_coalesced) {
+  const std::filesystem::path directory = test_directory("coalesce");
+  auto storage = std::make_shared<region_storage>(directory);
+  {
+    chunk_io io(storage, std::chrono::seconds(60));
+    for (block_type::block_t type = 1; type <= 5; type++) {
+      io.write(make_chunk({1, 2, 3}, type));
+    }
+    io.write(make_chunk({-1, 2, 3}, block_type::stone));
+    EXPECT_EQ(io.get_pending_writes(), 2);
+    EXPECT_EQ(io.get_coalesced_writes(), 4);
+
+    io.flush();
+    EXPECT_EQ(io.get_pending_writes(), 0);
+    EXPECT_EQ(storage->get_saved_chunks(), 2);
+    EXPECT_EQ(io.get_write_latency().count, 2);
+  }
+
+  std::unique_ptr<Chunk> loaded_chunk = storage->load_chunk({1, 2, 3});
+  ASSERT_NE(loaded_chunk, nullptr);
+  EXPECT_EQ(loaded_chunk->get_block(1, 2, 3).block_type, 5);
+  std::filesystem::remove_all(directory);
+}
+
+TEST(chunk_io, read_sees_pending_writes) {
+  const std::filesystem::path directory = test_directory("read_pending");
+  auto storage = std::make_shared<region_storage>(directory);
+  storage->save_chunk(*make_chunk({0, 0, 0}, block_type::dirt));
+
+  chunk_io io(storage, std::chrono::seconds(60));
+  io.write(make_chunk({0, 0, 0}, block_type::grass));
+
+  std::vector<std::unique_ptr<Chunk>> chunks = io.read({{0, 0, 0}, {7, 7, 7}}).get();
+  ASSERT_EQ(chunks.size(), 2);
+  ASSERT_NE(chunks[0], nullptr);
+  EXPECT_EQ(chunks[0]->get_block(1, 2, 3).block_type, block_type::grass);
+  EXPECT_TRUE(chunks[0]->is_saved());
+  EXPECT_EQ(chunks[1], nullptr);
+  // Still waiting for its delay
+  EXPECT_EQ(io.get_pending_writes(), 1);
+  EXPECT_EQ(io.get_read_latency().count, 1);
+  std::filesystem::remove_all(directory);
+}
+
+TEST(chunk_io, pending_writes_saved_on_destruction) {
+  const std::filesystem::path directory = test_directory("destruction");
+  auto storage = std::make_shared<region_storage>(directory);
+  {
+    chunk_io io(storage, std::chrono::seconds(60));
+    for (int32_t x = 0; x < 20; x++) {
+      io.write(make_chunk({x * 5, 0, 0}, block_type::sand));
+    }
+  }
+  EXPECT_EQ(storage->get_saved_chunks(), 20);
+  for (int32_t x = 0; x < 20; x++) {
+    EXPECT_TRUE(storage->contains({x * 5, 0, 0}));
+  }
+  std::filesystem::remove_all(directory);
+}
+
+TEST(chunk_io, storage_errors_do_not_stop_the_thread) {
+  const std::filesystem::path directory = test_directory("errors");
+  auto air_baseline = [](const benlib::Vector3i &pos) { return std::make_unique<Chunk>(Block(block_type::air), pos.x, pos.y, pos.z); };
+  auto failing_baseline = [](const benlib::Vector3i &) -> std::unique_ptr<Chunk> { throw std::runtime_error("baseline failed"); };
+  {
+    // Delta payload on disk, loading it needs the baseline
+    region_storage saved(directory);
+    saved.set_save_mode(region_save_mode::delta, air_baseline);
+    saved.save_chunk(*make_chunk({0, 0, 0}, block_type::dirt));
+  }
+
+  auto storage = std::make_shared<region_storage>(directory);
+  storage->set_save_mode(region_save_mode::delta, failing_baseline);
+  chunk_io io(storage, std::chrono::seconds(60));
+
+  std::future<std::vector<std::unique_ptr<Chunk>>> failed_read = io.read({{0, 0, 0}});
+  EXPECT_THROW(failed_read.get(), std::runtime_error);
+
+  std::unique_ptr<Chunk> edited_chunk = make_chunk({1, 0, 0}, block_type::stone);
+  edited_chunk->set_edited(true);
+  io.write(std::move(edited_chunk));
+  io.flush();
+  EXPECT_EQ(io.get_pending_writes(), 0);
+  EXPECT_EQ(io.get_failed_writes(), 1);
+  EXPECT_EQ(io.get_write_latency().count, 0);
+
+  // Still serving requests
+  std::vector<std::unique_ptr<Chunk>> chunks = io.read({{7, 7, 7}}).get();
+  ASSERT_EQ(chunks.size(), 1);
+  EXPECT_EQ(chunks[0], nullptr);
+  std::filesystem::remove_all(directory);
+}
+
+auto main(int argc, char **argv) -> int {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
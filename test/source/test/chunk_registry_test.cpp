@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Chunk.hpp"
+#include "chunk_registry.hpp"
+
+#include "gtest/gtest.h"
+
+static std::unique_ptr<Chunk> make_chunk(const benlib::Vector3i &pos) { return std::make_unique<Chunk>(Block(block_type::air), pos.x, pos.y, pos.z); }
+
+static void expect_found(const chunk_registry &chunks, const std::vector<benlib::Vector3i> &positions) {
+  for (const auto &pos : positions) {
+    const Chunk *current_chunk = chunks.find(pos);
+    ASSERT_NE(current_chunk, nullptr);
+    EXPECT_EQ(current_chunk->get_position().x, pos.x);
+    EXPECT_EQ(current_chunk->get_position().y, pos.y);
+    EXPECT_EQ(current_chunk->get_position().z, pos.z);
+  }
+}
+
+// Positions whose keys all start probing at the same slot of an index of the given capacity
+static std::vector<benlib::Vector3i> colliding_positions(const size_t count, const size_t capacity) {
+  std::vector<benlib::Vector3i> positions;
+  const size_t target = chunk_registry::hash(chunk_registry::pack(0, 0, 0)) & (capacity - 1);
+  for (int32_t x = 0; positions.size() < count; x++) {
+    if ((chunk_registry::hash(chunk_registry::pack(x, -3, 7)) & (capacity - 1)) == target) {
+      positions.push_back({x, -3, 7});
+    }
+  }
+  return positions;
+}
+
+TEST(chunk_registry, insert_and_find) {
+  chunk_registry chunks;
+  EXPECT_TRUE(chunks.empty());
+  EXPECT_TRUE(chunks.insert(make_chunk({1, -2, 3})));
+  EXPECT_TRUE(chunks.insert(make_chunk({-1048576, 1048575, 0})));
+  EXPECT_EQ(chunks.size(), 2);
+  expect_found(chunks, {{1, -2, 3}, {-1048576, 1048575, 0}});
+  EXPECT_EQ(chunks.find(3, -2, 1), nullptr);
+  EXPECT_FALSE(chunks.contains({0, 0, 0}));
+
+  std::unique_ptr<Chunk> null_chunk;
+  EXPECT_FALSE(chunks.insert(std::move(null_chunk)));
+}
+
+TEST(chunk_registry, duplicate_insert_keeps_both_chunks) {
+  chunk_registry chunks;
+  std::unique_ptr<Chunk> first = make_chunk({4, 5, 6});
+  const Chunk *first_ptr = first.get();
+  EXPECT_TRUE(chunks.insert(std::move(first)));
+
+  std::unique_ptr<Chunk> duplicate = make_chunk({4, 5, 6});
+  const Chunk *duplicate_ptr = duplicate.get();
+  EXPECT_FALSE(chunks.insert(std::move(duplicate)));
+  // Rejected: still owned by the caller, the registry keeps the first one
+  EXPECT_EQ(duplicate.get(), duplicate_ptr);
+  EXPECT_EQ(chunks.find(4, 5, 6), first_ptr);
+  EXPECT_EQ(chunks.size(), 1);
+}
+
+TEST(chunk_registry, erase_shifts_colliding_keys_back) {
+  chunk_registry chunks;
+  const size_t capacity = chunks.capacity();
+  // Below the max load of the initial index, no rehash
+  std::vector<benlib::Vector3i> positions = colliding_positions(8, capacity);
+  for (const auto &pos : positions) {
+    ASSERT_TRUE(chunks.insert(make_chunk(pos)));
+  }
+  ASSERT_EQ(chunks.capacity(), capacity);
+  expect_found(chunks, positions);
+
+  // Erase from the head, the middle and the tail of the probe run
+  for (const size_t i : {0, 3, 7}) {
+    EXPECT_TRUE(chunks.erase(positions[i]));
+    EXPECT_FALSE(chunks.erase(positions[i]));
+    EXPECT_EQ(chunks.find(positions[i]), nullptr);
+  }
+  std::vector<benlib::Vector3i> remaining;
+  for (size_t i = 0; i < positions.size(); i++) {
+    if (i != 0 && i != 3 && i != 7) {
+      remaining.push_back(positions[i]);
+    }
+  }
+  EXPECT_EQ(chunks.size(), remaining.size());
+  expect_found(chunks, remaining);
+
+  // The holes are reused
+  EXPECT_TRUE(chunks.insert(make_chunk(positions[3])));
+  expect_found(chunks, {positions[3]});
+}
+
+TEST(chunk_registry, rehash_and_erase_if) {
+  chunk_registry chunks;
+  const size_t initial_capacity = chunks.capacity();
+  std::vector<benlib::Vector3i> positions;
+  for (int32_t z = -8; z < 8; z++) {
+    for (int32_t y = -4; y < 4; y++) {
+      for (int32_t x = -8; x < 8; x++) {
+        positions.push_back({x, y, z});
+        ASSERT_TRUE(chunks.insert(make_chunk(positions.back())));
+      }
+    }
+  }
+  EXPECT_GT(chunks.capacity(), initial_capacity);
+  EXPECT_EQ(chunks.size(), positions.size());
+  expect_found(chunks, positions);
+
+  // Random erase order, the moved chunks of the dense storage are still indexed
+  std::mt19937 rng(42);
+  std::shuffle(positions.begin(), positions.end(), rng);
+  const size_t half = positions.size() / 2;
+  for (size_t i = 0; i < half; i++) {
+    ASSERT_TRUE(chunks.erase(positions[i]));
+  }
+  EXPECT_EQ(chunks.size(), positions.size() - half);
+  for (size_t i = 0; i < half; i++) {
+    EXPECT_FALSE(chunks.contains(positions[i]));
+  }
+  expect_found(chunks, std::vector<benlib::Vector3i>(positions.begin() + static_cast<std::ptrdiff_t>(half), positions.end()));
+
+  const size_t erased = chunks.erase_if([](const Chunk &current_chunk) { return current_chunk.get_position().y < 0; });
+  for (const auto &current_chunk : chunks) {
+    EXPECT_GE(current_chunk->get_position().y, 0);
+    EXPECT_EQ(chunks.find(current_chunk->get_position()), current_chunk.get());
+  }
+  EXPECT_EQ(chunks.size(), positions.size() - half - erased);
+
+  chunks.clear();
+  EXPECT_TRUE(chunks.empty());
+  EXPECT_EQ(chunks.capacity(), initial_capacity);
+  EXPECT_FALSE(chunks.contains(positions.back()));
+}
+
+auto main(int argc, char **argv) -> int {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,6 +1,14 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <random>
 #include <string>
 
+#include <omp.h>
+
 #include "Generator.hpp"
+#include "GeneratorPool.hpp"
 
 #include "Block.hpp"
 #include "Chunk.hpp"
@@ -19,7 +27,7 @@ TEST(world_of_blocks, basic_generation_2) {
   std::vector<std::unique_ptr<Chunk>> chunks = new_generator.generateChunks(-4, 0, -4, chunk_x, chunk_y, chunk_z, true);
 
   for (size_t i = 0; i < chunks.size(); i++) {
-    std::vector<Block> &blocks = chunks[i]->get_blocks();
+    std::vector<Block> blocks = chunks[i]->get_blocks();
     EXPECT_EQ(blocks.size(), Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z);
     for (size_t j = 0; j < blocks.size(); j++) {
       Block &b = blocks[j];
@@ -40,6 +48,676 @@ TEST(world_of_blocks, basic_generation_2) {
   }
 }
 
+// Sum of triangle areas per face normal
+static std::array<double, 6> mesh_face_area(const Mesh &mesh) {
+  std::array<double, 6> area = {0, 0, 0, 0, 0, 0};
+  for (int t = 0; t < mesh.triangleCount; t++) {
+    const float *a = &mesh.vertices[t * 9];
+    const float *b = &mesh.vertices[t * 9 + 3];
+    const float *c = &mesh.vertices[t * 9 + 6];
+    const float *n = &mesh.normals[t * 9];
+    const double ux = b[0] - a[0], uy = b[1] - a[1], uz = b[2] - a[2];
+    const double vx = c[0] - a[0], vy = c[1] - a[1], vz = c[2] - a[2];
+    const double cx = uy * vz - uz * vy, cy = uz * vx - ux * vz, cz = ux * vy - uy * vx;
+    // Winding must match the normal (front face)
+    EXPECT_GT(cx * n[0] + cy * n[1] + cz * n[2], 0.0);
+    const size_t axis = n[0] != 0.0f ? 0 : (n[1] != 0.0f ? 1 : 2);
+    const float sign = n[axis];
+    area[axis * 2 + (sign > 0 ? 0 : 1)] += std::sqrt(cx * cx + cy * cy + cz * cz) / 2.0;
+  }
+  return area;
+}
+
+TEST(world_of_blocks, greedy_mesh_same_surface) {
+  Generator new_generator(2510586073u);
+  world_model world_md = world_model();
+
+  for (int32_t chunk_y = -1; chunk_y <= 1; chunk_y++) {
+    std::unique_ptr<Chunk> chunk = new_generator.generateChunk(0, chunk_y, 0, true);
+
+    Mesh naive_mesh = world_md.generate_chunk_mesh(*chunk);
+    Mesh greedy_mesh = world_md.generate_chunk_mesh_greedy(*chunk);
+
+    EXPECT_LE(greedy_mesh.triangleCount, naive_mesh.triangleCount);
+
+    auto naive_area = mesh_face_area(naive_mesh);
+    auto greedy_area = mesh_face_area(greedy_mesh);
+    for (size_t i = 0; i < naive_area.size(); i++) {
+      EXPECT_NEAR(naive_area[i], greedy_area[i], 1e-3);
+    }
+
+    UnloadMesh(naive_mesh);
+    UnloadMesh(greedy_mesh);
+  }
+}
+
+// Greedy texture coordinates are in tile units: the span of each triangle matches its size in blocks on the face plane
+static void expect_greedy_tile_texcoords(const Mesh &mesh) {
+  for (int triangle = 0; triangle < mesh.triangleCount; triangle++) {
+    const float *position = mesh.vertices + triangle * 9;
+    const float *texcoords = mesh.texcoords + triangle * 6;
+    const float *normal = mesh.normals + triangle * 9;
+    const size_t axis = normal[0] != 0.0f ? 0 : (normal[1] != 0.0f ? 1 : 2);
+
+    std::array<float, 2> tex_span;
+    for (size_t i = 0; i < 2; i++) {
+      const float low = std::min({texcoords[i], texcoords[2 + i], texcoords[4 + i]});
+      const float high = std::max({texcoords[i], texcoords[2 + i], texcoords[4 + i]});
+      EXPECT_GE(low, 0.0f);
+      EXPECT_LE(high, static_cast<float>(Chunk::chunk_size_x));
+      tex_span[i] = high - low;
+    }
+    std::vector<float> block_span;
+    for (size_t i = 0; i < 3; i++) {
+      if (i != axis) {
+        block_span.push_back(std::max({position[i], position[3 + i], position[6 + i]}) - std::min({position[i], position[3 + i], position[6 + i]}));
+      }
+    }
+    std::sort(tex_span.begin(), tex_span.end());
+    std::sort(block_span.begin(), block_span.end());
+    EXPECT_FLOAT_EQ(tex_span[0], block_span[0]);
+    EXPECT_FLOAT_EQ(tex_span[1], block_span[1]);
+  }
+}
+
+TEST(world_of_blocks, greedy_mesh_texcoords) {
+  Generator new_generator(2510586073u);
+  world_model world_md = world_model();
+
+  for (int32_t chunk_y = -1; chunk_y <= 1; chunk_y++) {
+    std::unique_ptr<Chunk> chunk = new_generator.generateChunk(0, chunk_y, 0, true);
+    Mesh naive_mesh = world_md.generate_chunk_mesh(*chunk);
+    Mesh greedy_mesh = world_md.generate_chunk_mesh_greedy(*chunk);
+
+    // Naive faces sample the block tile of the atlas
+    const Rectangle tile = world_model::atlas_block_tile;
+    for (int i = 0; i < naive_mesh.vertexCount; i++) {
+      EXPECT_GE(naive_mesh.texcoords[i * 2], tile.x);
+      EXPECT_LE(naive_mesh.texcoords[i * 2], tile.x + tile.width);
+      EXPECT_GE(naive_mesh.texcoords[i * 2 + 1], tile.y);
+      EXPECT_LE(naive_mesh.texcoords[i * 2 + 1], tile.y + tile.height);
+    }
+    expect_greedy_tile_texcoords(greedy_mesh);
+
+    UnloadMesh(naive_mesh);
+    UnloadMesh(greedy_mesh);
+  }
+}
+
+TEST(world_of_blocks, greedy_mesh_texcoords_match_atlas_tile) {
+  // One block: every greedy quad is a single face, textured like the indexed naive face once mapped into the atlas tile
+  Chunk chunk(Block(block_type::air), 0, 0, 0);
+  chunk.set_block(5, 6, 7, Block(block_type::stone));
+  world_model world_md = world_model();
+  world_md.indexed_meshes = true;
+
+  Mesh naive_mesh = world_md.generate_chunk_mesh(chunk);
+  Mesh greedy_mesh = world_md.generate_chunk_mesh_greedy(chunk);
+  ASSERT_NE(naive_mesh.indices, nullptr);
+  ASSERT_EQ(greedy_mesh.vertexCount, 36);
+
+  const Rectangle tile = world_model::atlas_block_tile;
+  for (int i = 0; i < greedy_mesh.vertexCount; i++) {
+    const float *position = greedy_mesh.vertices + i * 3;
+    const float *normal = greedy_mesh.normals + i * 3;
+    bool found = false;
+    for (int j = 0; j < naive_mesh.vertexCount && !found; j++) {
+      if (std::memcmp(naive_mesh.vertices + j * 3, position, sizeof(float) * 3) != 0 || std::memcmp(naive_mesh.normals + j * 3, normal, sizeof(float) * 3) != 0) {
+        continue;
+      }
+      found = true;
+      EXPECT_FLOAT_EQ(tile.x + greedy_mesh.texcoords[i * 2] * tile.width, naive_mesh.texcoords[j * 2]);
+      EXPECT_FLOAT_EQ(tile.y + greedy_mesh.texcoords[i * 2 + 1] * tile.height, naive_mesh.texcoords[j * 2 + 1]);
+    }
+    EXPECT_TRUE(found);
+  }
+
+  UnloadMesh(naive_mesh);
+  UnloadMesh(greedy_mesh);
+}
+
+TEST(world_of_blocks, single_pass_mesh_same_as_naive) {
+  Generator new_generator(2510586073u);
+  world_model world_md = world_model();
+
+  for (int32_t chunk_y = -1; chunk_y <= 1; chunk_y++) {
+    std::unique_ptr<Chunk> chunk = new_generator.generateChunk(1, chunk_y, -1, true);
+
+    Mesh naive_mesh = world_md.generate_chunk_mesh(*chunk);
+    Mesh single_pass_mesh = world_md.generate_chunk_mesh_single_pass(*chunk);
+
+    ASSERT_EQ(naive_mesh.vertexCount, single_pass_mesh.vertexCount);
+    ASSERT_EQ(naive_mesh.triangleCount, single_pass_mesh.triangleCount);
+    EXPECT_EQ(std::memcmp(naive_mesh.vertices, single_pass_mesh.vertices, sizeof(float) * 3 * naive_mesh.vertexCount), 0);
+    EXPECT_EQ(std::memcmp(naive_mesh.normals, single_pass_mesh.normals, sizeof(float) * 3 * naive_mesh.vertexCount), 0);
+    EXPECT_EQ(std::memcmp(naive_mesh.texcoords, single_pass_mesh.texcoords, sizeof(float) * 2 * naive_mesh.vertexCount), 0);
+
+    UnloadMesh(naive_mesh);
+    UnloadMesh(single_pass_mesh);
+  }
+}
+
+TEST(world_of_blocks, bitmask_mesh_same_as_naive) {
+  Generator new_generator(2510586073u);
+  world_model world_md = world_model();
+
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (int32_t chunk_y = -1; chunk_y <= 1; chunk_y++) {
+    chunks.push_back(new_generator.generateChunk(-2, chunk_y, 3, true));
+  }
+  // Full chunk: only border faces would be visible, all blocks are buried
+  chunks.push_back(std::make_unique<Chunk>(std::vector<Block>(Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z, Block(block_type::stone)), 0, 0, 0));
+
+  for (auto &chunk : chunks) {
+    Mesh naive_mesh = world_md.generate_chunk_mesh(*chunk);
+    Mesh bitmask_mesh = world_md.generate_chunk_mesh_bitmask(*chunk);
+
+    ASSERT_EQ(naive_mesh.vertexCount, bitmask_mesh.vertexCount);
+    ASSERT_EQ(naive_mesh.triangleCount, bitmask_mesh.triangleCount);
+    EXPECT_EQ(std::memcmp(naive_mesh.vertices, bitmask_mesh.vertices, sizeof(float) * 3 * naive_mesh.vertexCount), 0);
+    EXPECT_EQ(std::memcmp(naive_mesh.normals, bitmask_mesh.normals, sizeof(float) * 3 * naive_mesh.vertexCount), 0);
+    EXPECT_EQ(std::memcmp(naive_mesh.texcoords, bitmask_mesh.texcoords, sizeof(float) * 2 * naive_mesh.vertexCount), 0);
+
+    UnloadMesh(naive_mesh);
+    UnloadMesh(bitmask_mesh);
+  }
+}
+
+TEST(world_of_blocks, bitmask_mesh_neighbour_culling) {
+  world_model world_md = world_model();
+  constexpr size_t block_count = Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z;
+  Chunk stone_chunk(std::vector<Block>(block_count, Block(block_type::stone)), 0, 0, 0);
+  Chunk air_chunk(std::vector<Block>(block_count, Block(block_type::air)), 1, 0, 0);
+  const chunk_occupancy stone = chunk_occupancy::build(stone_chunk);
+  const chunk_occupancy air = chunk_occupancy::build(air_chunk);
+
+  // Surrounded by stone: no face between chunks
+  const chunk_occupancy *neighbours[6] = {&stone, &stone, &stone, &stone, &stone, &stone};
+  Mesh buried_mesh = world_md.generate_chunk_mesh_bitmask(stone, neighbours);
+  EXPECT_EQ(buried_mesh.triangleCount, 0);
+  UnloadMesh(buried_mesh);
+
+  // Air on the west side only: one face per block of the west border
+  neighbours[world_model::west_face] = &air;
+  Mesh west_mesh = world_md.generate_chunk_mesh_bitmask(stone, neighbours);
+  EXPECT_EQ(west_mesh.triangleCount, Chunk::chunk_size_y * Chunk::chunk_size_z * 2);
+  UnloadMesh(west_mesh);
+}
+
+TEST(world_of_blocks, noise_lattice_matches_on_lattice_points) {
+  Generator full_generator(2510586073u);
+  Generator coarse_generator(2510586073u);
+  coarse_generator.set_noise_lattice(4, 8);
+
+  const uint32_t size = Chunk::chunk_size_x;
+  const std::vector<uint32_t> full = full_generator.generate3dHeightmap(-32, 0, 64, size, size, size);
+  const std::vector<uint32_t> coarse = coarse_generator.generate3dHeightmap(-32, 0, 64, size, size, size);
+  ASSERT_EQ(full.size(), coarse.size());
+
+  for (uint32_t z = 0; z < size; z += 4) {
+    for (uint32_t y = 0; y < size; y += 8) {
+      for (uint32_t x = 0; x < size; x += 4) {
+        const size_t index = math::convert_to_1d(x, y, z, size, size, size);
+        EXPECT_EQ(full[index], coarse[index]);
+      }
+    }
+  }
+}
+
+TEST(world_of_blocks, classifier_same_as_full_generation) {
+  for (const uint32_t seed : {2510586073u, 404u, 1337u}) {
+    Generator classified_generator(seed);
+    Generator full_generator(seed);
+    full_generator.set_classifier_samples(0);
+
+    size_t classified_count = 0;
+    for (int32_t chunk_y = -6; chunk_y <= 6; chunk_y++) {
+      for (int32_t chunk_x = -2; chunk_x <= 2; chunk_x++) {
+        const int32_t chunk_z = chunk_x * 3;
+        const chunk_class _class = classified_generator.classify3d(chunk_x * Chunk::chunk_size_x, chunk_y * Chunk::chunk_size_y, chunk_z * Chunk::chunk_size_z,
+                                                                   Chunk::chunk_size_x, Chunk::chunk_size_y, Chunk::chunk_size_z);
+        classified_count += _class != chunk_class::mixed;
+
+        std::unique_ptr<Chunk> classified_chunk = classified_generator.generateChunk(chunk_x, chunk_y, chunk_z, true);
+        std::unique_ptr<Chunk> full_chunk = full_generator.generateChunk(chunk_x, chunk_y, chunk_z, true);
+
+        const std::vector<Block> classified_blocks = classified_chunk->get_blocks();
+        const std::vector<Block> full_blocks = full_chunk->get_blocks();
+        ASSERT_EQ(classified_blocks.size(), full_blocks.size());
+        for (size_t i = 0; i < full_blocks.size(); i++) {
+          ASSERT_EQ(classified_blocks[i].block_type, full_blocks[i].block_type) << "seed " << seed << ", chunk " << chunk_x << " " << chunk_y << " " << chunk_z;
+        }
+      }
+    }
+    RecordProperty("classified_chunks_seed_" + std::to_string(seed), static_cast<int>(classified_count));
+  }
+}
+
+TEST(world_of_blocks, threshold_kernel_same_as_heightmap) {
+  for (const uint32_t multiplier : {128u, 100u, 61u, 255u}) {
+    const float noise_threshold = Generator::stone_noise_threshold(multiplier);
+
+    // Random noise values, plus values around the threshold
+    std::mt19937 gen(multiplier);
+    std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+    std::vector<float> noise(4096);
+    for (auto &value : noise) {
+      value = dis(gen);
+    }
+    float value = noise_threshold;
+    for (int i = 0; i < 16; i++) {
+      value = std::nextafter(value, -2.0f);
+    }
+    for (int i = 0; i < 32; i++) {
+      noise.push_back(value);
+      value = std::nextafter(value, 2.0f);
+    }
+
+    std::vector<block_type::block_t> blocks(noise.size());
+    Generator::threshold_blocks(noise.data(), blocks.data(), noise.size(), noise_threshold);
+    for (size_t i = 0; i < noise.size(); i++) {
+      const bool is_stone = static_cast<uint32_t>((noise[i] + 1.0) * multiplier) > 120;
+      ASSERT_EQ(blocks[i], is_stone ? block_type::stone : block_type::air) << "noise " << noise[i] << ", multiplier " << multiplier;
+    }
+  }
+}
+
+// Each indexed triangle has the same corners and winding as the un-indexed one (up to a rotation of its vertices)
+static void expect_same_triangles(const Mesh &flat_mesh, const Mesh &indexed_mesh) {
+  ASSERT_EQ(flat_mesh.triangleCount, indexed_mesh.triangleCount);
+  ASSERT_EQ(indexed_mesh.vertexCount * 3, flat_mesh.vertexCount * 2);
+  ASSERT_NE(indexed_mesh.indices, nullptr);
+
+  const auto same_vertex = [&](const size_t flat_vertex, const size_t indexed_vertex) {
+    for (size_t i = 0; i < 3; i++) {
+      if (flat_mesh.vertices[flat_vertex * 3 + i] != indexed_mesh.vertices[indexed_vertex * 3 + i] ||
+          flat_mesh.normals[flat_vertex * 3 + i] != indexed_mesh.normals[indexed_vertex * 3 + i]) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (size_t triangle = 0; triangle < static_cast<size_t>(flat_mesh.triangleCount); triangle++) {
+    bool match = false;
+    for (size_t rotation = 0; rotation < 3 && !match; rotation++) {
+      match = true;
+      for (size_t corner = 0; corner < 3; corner++) {
+        match = match && same_vertex(triangle * 3 + corner, indexed_mesh.indices[triangle * 3 + (corner + rotation) % 3]);
+      }
+    }
+    ASSERT_TRUE(match) << "triangle " << triangle;
+  }
+}
+
+TEST(world_of_blocks, indexed_mesh_same_geometry) {
+  Generator new_generator(2510586073u);
+  world_model flat_md = world_model();
+  world_model indexed_md = world_model();
+  indexed_md.indexed_meshes = true;
+
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (int32_t chunk_y = -1; chunk_y <= 1; chunk_y++) {
+    chunks.push_back(new_generator.generateChunk(1, chunk_y, -3, true));
+  }
+  // Random blocks, so there are faces whatever the terrain
+  std::mt19937 gen(42);
+  std::bernoulli_distribution dis(0.05);
+  std::vector<Block> random_blocks(Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z);
+  for (auto &block : random_blocks) {
+    block.block_type = dis(gen) ? block_type::stone : block_type::air;
+  }
+  chunks.push_back(std::make_unique<Chunk>(random_blocks, 0, 0, 0));
+
+  for (auto &chunk : chunks) {
+    Mesh flat_mesh = flat_md.generate_chunk_mesh(*chunk);
+    Mesh indexed_mesh = indexed_md.generate_chunk_mesh(*chunk);
+    Mesh indexed_bitmask_mesh = indexed_md.generate_chunk_mesh_bitmask(*chunk);
+
+    expect_same_triangles(flat_mesh, indexed_mesh);
+    expect_same_triangles(flat_mesh, indexed_bitmask_mesh);
+    if (flat_mesh.triangleCount > 0) {
+      EXPECT_LT(world_model::mesh_size_bytes(indexed_mesh), world_model::mesh_size_bytes(flat_mesh));
+    }
+
+    UnloadMesh(flat_mesh);
+    UnloadMesh(indexed_mesh);
+    UnloadMesh(indexed_bitmask_mesh);
+  }
+}
+
+TEST(world_of_blocks, column_cache_stacked_chunks_continuous) {
+  Generator cached_generator(2510586073u);
+  Generator uncached_generator(2510586073u);
+  uncached_generator.set_column_cache_capacity(0);
+
+  constexpr int32_t chunk_x = 2;
+  constexpr int32_t chunk_z = -1;
+  constexpr int32_t column_height = 3;
+  const std::vector<uint32_t> heightmap = uncached_generator.generate2dMeightmap(chunk_x * Chunk::chunk_size_x, 0, chunk_z * Chunk::chunk_size_z,
+                                                                                 Chunk::chunk_size_x, Chunk::chunk_size_y, Chunk::chunk_size_z);
+
+  for (int32_t chunk_y = 0; chunk_y < column_height; chunk_y++) {
+    auto cached_chunk = cached_generator.generateChunk(chunk_x, chunk_y, chunk_z, false);
+    auto uncached_chunk = uncached_generator.generateChunk(chunk_x, chunk_y, chunk_z, false);
+    const std::vector<Block> cached_blocks = cached_chunk->get_blocks();
+    const std::vector<Block> uncached_blocks = uncached_chunk->get_blocks();
+    for (size_t i = 0; i < cached_blocks.size(); i++) {
+      ASSERT_EQ(cached_blocks[i].block_type, uncached_blocks[i].block_type) << "index: " << i;
+    }
+
+    // Stone exactly below the column height, in world y
+    for (uint32_t z = 0; z < Chunk::chunk_size_z; z++) {
+      for (uint32_t x = 0; x < Chunk::chunk_size_x; x++) {
+        const int32_t height = static_cast<int32_t>(heightmap[z * Chunk::chunk_size_x + x] / 4);
+        for (uint32_t y = 0; y < Chunk::chunk_size_y; y++) {
+          const int32_t world_y = chunk_y * Chunk::chunk_size_y + static_cast<int32_t>(y);
+          const auto expected = world_y < height ? block_type::stone : block_type::air;
+          ASSERT_EQ(cached_chunk->get_block(x, y, z).block_type, expected) << "x: " << x << ", world y: " << world_y << ", z: " << z;
+        }
+      }
+    }
+  }
+
+  EXPECT_EQ(cached_generator.get_column_cache().get_misses(), 1u);
+  EXPECT_EQ(cached_generator.get_column_cache().get_hits(), static_cast<uint64_t>(column_height - 1));
+  EXPECT_EQ(uncached_generator.get_column_cache().size(), 0u);
+}
+
+TEST(world_of_blocks, region_same_as_chunk_generation) {
+  // 3 does not divide the chunk size and 64 is larger than a chunk, both are lowered to a divisor
+  for (const uint32_t lattice_step : {1u, 4u, 3u, 64u}) {
+    Generator chunk_generator(2510586073u);
+    EXPECT_EQ(chunk_generator.set_noise_lattice(lattice_step, lattice_step), Chunk::chunk_size_x % lattice_step == 0);
+    EXPECT_EQ(Chunk::chunk_size_x % chunk_generator.get_noise_lattice_xz(), 0);
+    EXPECT_EQ(Chunk::chunk_size_y % chunk_generator.get_noise_lattice_y(), 0);
+    Generator region_generator(chunk_generator);
+    GeneratorPool pool(chunk_generator, 2);
+
+    const benlib::Vector3i begin = {-1, -1, 0};
+    const benlib::Vector3i size = {3, 3, 2};
+    const std::vector<std::unique_ptr<Chunk>> region_chunks = region_generator.generate_region(begin.x, begin.y, begin.z, size.x, size.y, size.z, true);
+    const std::vector<std::unique_ptr<Chunk>> pool_chunks = pool.generate_region(begin, size, true, 2);
+    ASSERT_EQ(region_chunks.size(), static_cast<size_t>(size.x * size.y * size.z));
+    ASSERT_EQ(pool_chunks.size(), region_chunks.size());
+
+    size_t i = 0;
+    for (int32_t z = begin.z; z < begin.z + size.z; z++) {
+      for (int32_t y = begin.y; y < begin.y + size.y; y++) {
+        for (int32_t x = begin.x; x < begin.x + size.x; x++, i++) {
+          const std::unique_ptr<Chunk> expected_chunk = chunk_generator.generateChunk(x, y, z, true);
+          const std::vector<Block> expected_blocks = expected_chunk->get_blocks();
+          for (const Chunk *chunk : {region_chunks[i].get(), pool_chunks[i].get()}) {
+            ASSERT_EQ(chunk->get_position().x, x);
+            ASSERT_EQ(chunk->get_position().y, y);
+            ASSERT_EQ(chunk->get_position().z, z);
+            const std::vector<Block> blocks = chunk->get_blocks();
+            for (size_t j = 0; j < blocks.size(); j++) {
+              ASSERT_EQ(blocks[j].block_type, expected_blocks[j].block_type) << "lattice " << lattice_step << ", chunk " << x << " " << y << " " << z;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(world_of_blocks, generate_chunks_same_for_any_thread_count) {
+  const int32_t begin_x = -2, begin_y = -1, begin_z = 1;
+  const uint32_t size_x = 3, size_y = 2, size_z = 4;
+  const int max_threads = std::max(omp_get_max_threads(), 4);
+
+  std::vector<std::vector<Block>> reference_blocks;
+  for (int threads = 1; threads <= max_threads; threads++) {
+    omp_set_num_threads(threads);
+    Generator new_generator(2510586073u);
+    const std::vector<std::unique_ptr<Chunk>> chunks = new_generator.generateChunks(begin_x, begin_y, begin_z, size_x, size_y, size_z, true);
+    ASSERT_EQ(chunks.size(), static_cast<size_t>(size_x * size_y * size_z));
+
+    size_t i = 0;
+    for (uint32_t z = 0; z < size_z; z++) {
+      for (uint32_t y = 0; y < size_y; y++) {
+        for (uint32_t x = 0; x < size_x; x++, i++) {
+          ASSERT_NE(chunks[i], nullptr);
+          EXPECT_EQ(chunks[i]->get_position().x, begin_x + static_cast<int32_t>(x));
+          EXPECT_EQ(chunks[i]->get_position().y, begin_y + static_cast<int32_t>(y));
+          EXPECT_EQ(chunks[i]->get_position().z, begin_z + static_cast<int32_t>(z));
+
+          const std::vector<Block> blocks = chunks[i]->get_blocks();
+          if (threads == 1) {
+            reference_blocks.push_back(blocks);
+            continue;
+          }
+          ASSERT_EQ(std::memcmp(blocks.data(), reference_blocks[i].data(), blocks.size() * sizeof(Block)), 0) << "threads " << threads << ", chunk " << i;
+        }
+      }
+    }
+  }
+  omp_set_num_threads(omp_get_num_procs());
+}
+
+TEST(world_of_blocks, terrain_stages_layers) {
+  Generator new_generator(2510586073u);
+  new_generator.set_sea_level(8);
+  new_generator.set_caves(false);
+
+  // Synthetic density: ground height from 4 to 11 along x, 2 blocks of overhang ground in the apron above column x = 0
+  terrain_buffer buffer;
+  new_generator.prepare_terrain_buffer(buffer, 0, 0, 0);
+  const auto at = [&](const int32_t x, const int32_t y, const int32_t z) -> block_type::block_t & {
+    return buffer.blocks[math::convert_to_1d<size_t>(x, y, z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z)];
+  };
+  const auto ground_height = [](const int32_t x) { return 4 + x / 4; };
+  for (int32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    for (int32_t y = 0; y < static_cast<int32_t>(buffer.size_y); y++) {
+      for (int32_t x = 0; x < Chunk::chunk_size_x; x++) {
+        const bool overhang = x == 0 && y >= Chunk::chunk_size_y - 1;
+        at(x, y, z) = y < ground_height(x) || overhang ? block_type::stone : block_type::air;
+      }
+    }
+  }
+
+  new_generator.terrain_surface(buffer);
+  new_generator.terrain_water(buffer);
+  new_generator.terrain_caves(buffer);
+
+  for (int32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    for (int32_t x = 0; x < Chunk::chunk_size_x; x++) {
+      const int32_t top = ground_height(x) - 1;
+      // Near the sea level the surface is sand, grass and dirt above it
+      const bool sandy = top <= new_generator.get_sea_level() + 1;
+      EXPECT_EQ(at(x, top, z), sandy ? block_type::sand : block_type::grass) << "x: " << x;
+      EXPECT_EQ(at(x, top - 1, z), sandy ? block_type::sand : block_type::dirt) << "x: " << x;
+      EXPECT_EQ(at(x, top - 2, z), sandy ? block_type::sand : block_type::dirt) << "x: " << x;
+      EXPECT_EQ(at(x, top - 3, z), block_type::stone) << "x: " << x;
+      for (int32_t y = top + 1; y < Chunk::chunk_size_y - 1; y++) {
+        EXPECT_EQ(at(x, y, z), y < new_generator.get_sea_level() ? block_type::water : block_type::air) << "x: " << x << ", y: " << y;
+      }
+    }
+    // Chunk top under the apron ground: it is the top of the ground, not a buried block
+    EXPECT_EQ(at(0, Chunk::chunk_size_y - 1, z), block_type::stone);
+  }
+
+  // Trees only stand on grass, with their whole trunk inside the chunk
+  new_generator.terrain_decoration(buffer);
+  size_t wood_count = 0;
+  for (int32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    for (int32_t x = 0; x < Chunk::chunk_size_x; x++) {
+      for (int32_t y = 1; y < Chunk::chunk_size_y; y++) {
+        if (at(x, y, z) == block_type::wood) {
+          wood_count++;
+          EXPECT_TRUE(at(x, y - 1, z) == block_type::wood || at(x, y - 1, z) == block_type::grass) << "x: " << x << ", y: " << y << ", z: " << z;
+        }
+      }
+    }
+  }
+  EXPECT_GT(wood_count, 0u);
+}
+
+TEST(world_of_blocks, terrain_stages_generated_chunks) {
+  Generator new_generator(2510586073u);
+  new_generator.set_sea_level(8);
+
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (int32_t chunk_x = -3; chunk_x <= 3; chunk_x++) {
+    for (int32_t chunk_y = -1; chunk_y <= 1; chunk_y++) {
+      chunks.push_back(new_generator.generateChunk(chunk_x, chunk_y, -2, true));
+    }
+  }
+
+  for (const auto &chunk : chunks) {
+    const int32_t begin_y = chunk->get_position().y * Chunk::chunk_size_y;
+    for (int32_t z = 0; z < Chunk::chunk_size_z; z++) {
+      for (int32_t y = 0; y < Chunk::chunk_size_y; y++) {
+        for (int32_t x = 0; x < Chunk::chunk_size_x; x++) {
+          const auto block = chunk->get_block(x, y, z).block_type;
+          EXPECT_LE(block, block_type::leaves);
+          if (block == block_type::water) {
+            ASSERT_LT(begin_y + y, new_generator.get_sea_level());
+          }
+          if (block == block_type::grass && y + 1 < Chunk::chunk_size_y) {
+            const auto above = chunk->get_block(x, y + 1, z).block_type;
+            ASSERT_TRUE(above == block_type::air || above == block_type::wood || above == block_type::leaves);
+          }
+        }
+      }
+    }
+  }
+
+  const terrain_stage_times times = new_generator.get_stage_times();
+  EXPECT_EQ(times.chunks, chunks.size());
+  new_generator.reset_stage_times();
+  EXPECT_EQ(new_generator.get_stage_times().chunks, 0u);
+}
+
+// Chunk of a flat world (ground up to world y 30, so trees cross the chunk top) through the surface and decoration stages, then its pending blocks
+static std::unique_ptr<Chunk> generate_flat_forest_chunk(Generator &generator, const benlib::Vector3i &pos) {
+  terrain_buffer buffer;
+  generator.prepare_terrain_buffer(buffer, pos.x, pos.y, pos.z);
+  for (int32_t z = 0; z < Chunk::chunk_size_z; z++) {
+    for (int32_t y = 0; y < static_cast<int32_t>(buffer.size_y); y++) {
+      const auto type = buffer.begin_y + y < 30 ? block_type::stone : block_type::air;
+      std::fill_n(buffer.blocks.begin() + math::convert_to_1d<size_t>(0, y, z, Chunk::chunk_size_x, buffer.size_y, Chunk::chunk_size_z),
+                  Chunk::chunk_size_x, type);
+    }
+  }
+  generator.terrain_surface(buffer);
+  generator.terrain_decoration(buffer);
+  generator.publish_decorations(buffer);
+  auto chunk = Generator::chunk_from_terrain(buffer, pos.x, pos.y, pos.z);
+  generator.apply_pending_decorations(*chunk);
+  return chunk;
+}
+
+TEST(world_of_blocks, cross_chunk_trees_same_for_any_order) {
+  std::vector<benlib::Vector3i> positions;
+  for (int32_t z = -1; z <= 1; z++) {
+    for (int32_t y = 0; y <= 1; y++) {
+      for (int32_t x = -1; x <= 1; x++) {
+        positions.push_back({x, y, z});
+      }
+    }
+  }
+
+  // Generate all chunks in one order, then place the blocks that reached chunks generated before their tree (loaded chunks)
+  const auto generate_all = [&](const std::vector<benlib::Vector3i> &order) {
+    Generator new_generator(2510586073u);
+    new_generator.set_tree_rarity(8);
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    for (const auto &pos : order) {
+      chunks.push_back(generate_flat_forest_chunk(new_generator, pos));
+    }
+    for (auto &chunk : chunks) {
+      new_generator.apply_pending_decorations(*chunk);
+    }
+    EXPECT_GT(new_generator.get_decoration_store().size(), 0u);
+    return chunks;
+  };
+
+  std::vector<benlib::Vector3i> reversed_positions(positions.rbegin(), positions.rend());
+  const auto chunks = generate_all(positions);
+  auto reversed_chunks = generate_all(reversed_positions);
+  std::reverse(reversed_chunks.begin(), reversed_chunks.end());
+
+  size_t leaves_count = 0;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    const std::vector<Block> blocks = chunks[i]->get_blocks();
+    const std::vector<Block> reversed_blocks = reversed_chunks[i]->get_blocks();
+    ASSERT_EQ(std::memcmp(blocks.data(), reversed_blocks.data(), blocks.size() * sizeof(Block)), 0) << "chunk " << i;
+    for (const auto &block : blocks) {
+      leaves_count += block.block_type == block_type::leaves;
+    }
+  }
+  EXPECT_GT(leaves_count, 0u);
+
+  // Trunks always stand on grass or wood, also across chunk borders
+  const auto block_at = [&](const int32_t x, const int32_t y, const int32_t z) {
+    const auto floor_div = [](const int32_t v, const int32_t size) { return v < 0 ? (v + 1) / size - 1 : v / size; };
+    const benlib::Vector3i pos = {floor_div(x, Chunk::chunk_size_x), floor_div(y, Chunk::chunk_size_y), floor_div(z, Chunk::chunk_size_z)};
+    const auto it = std::find_if(positions.begin(), positions.end(), [&](const auto &p) { return p.x == pos.x && p.y == pos.y && p.z == pos.z; });
+    return chunks[static_cast<size_t>(it - positions.begin())]
+        ->get_block(x - pos.x * Chunk::chunk_size_x, y - pos.y * Chunk::chunk_size_y, z - pos.z * Chunk::chunk_size_z)
+        .block_type;
+  };
+  size_t wood_count = 0;
+  size_t upper_wood_count = 0;
+  for (int32_t z = -Chunk::chunk_size_z; z < 2 * Chunk::chunk_size_z; z++) {
+    for (int32_t x = -Chunk::chunk_size_x; x < 2 * Chunk::chunk_size_x; x++) {
+      for (int32_t y = 1; y < 2 * Chunk::chunk_size_y; y++) {
+        if (block_at(x, y, z) == block_type::wood) {
+          wood_count++;
+          upper_wood_count += y >= Chunk::chunk_size_y;
+          const auto below = block_at(x, y - 1, z);
+          EXPECT_TRUE(below == block_type::wood || below == block_type::grass) << "x: " << x << ", y: " << y << ", z: " << z;
+        }
+      }
+    }
+  }
+  EXPECT_GT(wood_count, 0u);
+  EXPECT_GT(upper_wood_count, 0u);
+}
+
+TEST(world_of_blocks, loaded_chunk_trees_published_again) {
+  // Trees of the chunk cross its top and its sides
+  Generator generator(2510586073u);
+  generator.set_tree_rarity(8);
+  const std::unique_ptr<Chunk> chunk = generate_flat_forest_chunk(generator, {0, 0, 0});
+
+  // Same chunk loaded from disk by another session, nothing pending yet
+  Generator loading_generator(2510586073u);
+  loading_generator.set_tree_rarity(8);
+  const Chunk loaded_chunk(chunk->get_storage(), 0, 0, 0);
+  loading_generator.republish_decorations(loaded_chunk);
+
+  const auto sorted_blocks = [](std::vector<pending_block> blocks) {
+    std::sort(blocks.begin(), blocks.end(), [](const auto &a, const auto &b) { return a.index != b.index ? a.index < b.index : a.block_type < b.block_type; });
+    return blocks;
+  };
+  size_t published_count = 0;
+  for (int32_t z = -1; z <= 1; z++) {
+    for (int32_t y = -1; y <= 1; y++) {
+      for (int32_t x = -1; x <= 1; x++) {
+        const auto expected = sorted_blocks(generator.get_decoration_store().get({x, y, z}));
+        const auto republished = sorted_blocks(loading_generator.get_decoration_store().get({x, y, z}));
+        ASSERT_EQ(expected.size(), republished.size()) << "x: " << x << ", y: " << y << ", z: " << z;
+        for (size_t i = 0; i < expected.size(); i++) {
+          EXPECT_EQ(expected[i].index, republished[i].index);
+          EXPECT_EQ(expected[i].block_type, republished[i].block_type);
+        }
+        published_count += expected.size();
+      }
+    }
+  }
+  EXPECT_GT(published_count, 0u);
+
+  // Neighbour generated after the load: same blocks as after the original chunk
+  const auto above = generate_flat_forest_chunk(generator, {0, 1, 0});
+  const auto above_after_load = generate_flat_forest_chunk(loading_generator, {0, 1, 0});
+  const std::vector<Block> blocks = above->get_blocks();
+  const std::vector<Block> blocks_after_load = above_after_load->get_blocks();
+  EXPECT_EQ(std::memcmp(blocks.data(), blocks_after_load.data(), blocks.size() * sizeof(Block)), 0);
+}
+
 auto main(int argc, char **argv) -> int {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,85 @@
+#include <random>
+#include <vector>
+
+#include "Block.hpp"
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "palette_storage.hpp"
+
+#include "gtest/gtest.h"
+
+static constexpr size_t block_count = Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z;
+
+TEST(palette_storage, uniform_chunk_has_no_indices) {
+  palette_storage storage(std::vector<Block>(block_count, Block(block_type::stone)));
+
+  EXPECT_EQ(storage.size(), block_count);
+  EXPECT_EQ(storage.bits_per_block(), 0);
+  EXPECT_EQ(storage.get(0), block_type::stone);
+  EXPECT_EQ(storage.get(block_count - 1), block_type::stone);
+  EXPECT_LT(storage.memory_bytes(), 64);
+}
+
+TEST(palette_storage, same_blocks_as_vector) {
+  Generator generator(2510586073u);
+  std::unique_ptr<Chunk> chunk = generator.generateChunk(0, 0, 0, true);
+
+  const std::vector<Block> blocks = chunk->get_blocks();
+  palette_storage storage(blocks);
+  ASSERT_EQ(storage.size(), blocks.size());
+  for (size_t i = 0; i < blocks.size(); i++) {
+    ASSERT_EQ(storage.get(i), blocks[i].block_type);
+  }
+  EXPECT_LT(storage.memory_bytes(), blocks.size() * sizeof(Block));
+}
+
+TEST(palette_storage, grows_on_set) {
+  std::vector<Block> blocks(block_count, Block(block_type::air));
+  palette_storage storage(blocks);
+
+  // Set random block types, the palette and the index width grow on demand
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> index_dis(0, block_count - 1);
+  std::uniform_int_distribution<int> type_dis(block_type::air, block_type::leaves);
+  for (size_t i = 0; i < 10000; i++) {
+    const size_t index = index_dis(gen);
+    const auto type = static_cast<block_type::block_t>(type_dis(gen));
+    blocks[index].block_type = type;
+    storage.set(index, type);
+  }
+  EXPECT_EQ(storage.bits_per_block(), 4);
+
+  const std::vector<Block> unpacked = storage.to_blocks();
+  for (size_t i = 0; i < blocks.size(); i++) {
+    ASSERT_EQ(unpacked[i].block_type, blocks[i].block_type);
+  }
+
+  // Only air and stone left: compact back to 1 bit
+  for (size_t i = 0; i < blocks.size(); i++) {
+    storage.set(i, i % 3 == 0 ? block_type::stone : block_type::air);
+  }
+  storage.compact();
+  EXPECT_EQ(storage.bits_per_block(), 1);
+  EXPECT_EQ(storage.get(3), block_type::stone);
+  EXPECT_EQ(storage.get(4), block_type::air);
+}
+
+TEST(palette_storage, uniform_chunk_expands_on_edit) {
+  Chunk chunk(Block(block_type::air), 0, 8, 0);
+  EXPECT_TRUE(chunk.is_uniform());
+  EXPECT_EQ(chunk.get_uniform_block().block_type, block_type::air);
+
+  // Same type: still uniform
+  chunk.set_block(1, 2, 3, Block(block_type::air));
+  EXPECT_TRUE(chunk.is_uniform());
+
+  chunk.set_block(1, 2, 3, Block(block_type::stone));
+  EXPECT_FALSE(chunk.is_uniform());
+  EXPECT_EQ(chunk.get_block(1, 2, 3).block_type, block_type::stone);
+  EXPECT_EQ(chunk.get_block(3, 2, 1).block_type, block_type::air);
+}
+
+auto main(int argc, char **argv) -> int {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
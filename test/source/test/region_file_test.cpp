@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Chunk.hpp"
+#include "Generator.hpp"
+#include "region_file.hpp"
+
+#include "gtest/gtest.h"
+
+static constexpr size_t block_count = Chunk::chunk_size_x * Chunk::chunk_size_y * Chunk::chunk_size_z;
+
+// Empty directory for the test region files
+static std::filesystem::path test_directory(const std::string &name) {
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / ("world_of_blocks_" + name);
+  std::filesystem::remove_all(directory);
+  return directory;
+}
+
+static void expect_same_blocks(const Chunk &a, const Chunk &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    ASSERT_EQ(a.get_storage().get(i), b.get_storage().get(i)) << "block " << i;
+  }
+}
+
+TEST(region_file, chunk_index_and_region_position) {
+  EXPECT_EQ(region_file::region_position({0, 0, 0}).x, 0);
+  EXPECT_EQ(region_file::region_position({15, 0, 0}).x, 0);
+  EXPECT_EQ(region_file::region_position({16, 0, 0}).x, 1);
+  EXPECT_EQ(region_file::region_position({-1, 0, 0}).x, -1);
+  EXPECT_EQ(region_file::region_position({-16, 0, 0}).x, -1);
+  EXPECT_EQ(region_file::region_position({-17, 0, 0}).x, -2);
+
+  EXPECT_EQ(region_file::chunk_index({0, 0, 0}), 0);
+  EXPECT_EQ(region_file::chunk_index({-1, 0, 0}), 15);
+  EXPECT_EQ(region_file::chunk_index({1, 2, 3}), 1 + 2 * 16 + 3 * 16 * 16);
+  EXPECT_EQ(region_file::chunk_index({-16, -16, -16}), 0);
+}
+
+TEST(region_file, encode_decode_blocks) {
+  std::vector<Block> blocks(block_count, Block(block_type::air));
+  for (size_t i = 0; i < block_count; i += 7) {
+    blocks[i].block_type = static_cast<block_type::block_t>(i % 5);
+  }
+  const palette_storage storage(blocks);
+
+  const std::vector<uint8_t> data = region_file::encode_blocks(storage);
+  palette_storage decoded;
+  ASSERT_TRUE(region_file::decode_blocks(data.data(), data.size(), decoded));
+  ASSERT_EQ(decoded.size(), storage.size());
+  EXPECT_EQ(decoded.bits_per_block(), storage.bits_per_block());
+  for (size_t i = 0; i < block_count; i++) {
+    ASSERT_EQ(decoded.get(i), storage.get(i));
+  }
+
+  // Truncated payload
+  EXPECT_FALSE(region_file::decode_blocks(data.data(), data.size() - 8, decoded));
+}
+
+TEST(region_file, save_and_load_generated_chunks) {
+  const std::filesystem::path directory = test_directory("save_and_load");
+  Generator generator(2510586073u);
+
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (int32_t x = -2; x < 2; x++) {
+    for (int32_t y = -1; y < 1; y++) {
+      chunks.push_back(generator.generateChunk(x, y, 15 + x, true));
+    }
+  }
+
+  {
+    region_storage storage(directory);
+    storage.save_chunks(chunks);
+    EXPECT_EQ(storage.get_saved_chunks(), chunks.size());
+    EXPECT_GT(storage.get_bytes_written(), 0);
+  }
+
+  // Reopened from disk
+  region_storage storage(directory);
+  for (const auto &current_chunk : chunks) {
+    const benlib::Vector3i pos = current_chunk->get_position();
+    ASSERT_TRUE(storage.contains(pos));
+    std::unique_ptr<Chunk> loaded_chunk = storage.load_chunk(pos);
+    ASSERT_NE(loaded_chunk, nullptr);
+    EXPECT_TRUE(loaded_chunk->is_saved());
+    EXPECT_EQ(loaded_chunk->get_position().x, pos.x);
+    EXPECT_EQ(loaded_chunk->get_position().y, pos.y);
+    EXPECT_EQ(loaded_chunk->get_position().z, pos.z);
+    expect_same_blocks(*current_chunk, *loaded_chunk);
+  }
+  EXPECT_FALSE(storage.contains({5, 5, 5}));
+  EXPECT_EQ(storage.load_chunk({5, 5, 5}), nullptr);
+  EXPECT_EQ(storage.get_loaded_chunks(), chunks.size());
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(region_file, overwrite_chunk) {
+  const std::filesystem::path directory = test_directory("overwrite");
+  region_storage storage(directory);
+
+  // Uniform chunk first (small slot), then a bigger edited one, then uniform again (in place)
+  Chunk current_chunk(Block(block_type::stone), 3, -4, 5);
+  storage.save_chunk(current_chunk);
+  for (int x = 0; x < Chunk::chunk_size_x; x++) {
+    current_chunk.set_block(x, x % Chunk::chunk_size_y, 7, Block(block_type::grass));
+  }
+  EXPECT_FALSE(current_chunk.is_saved());
+  storage.save_chunk(current_chunk);
+
+  std::unique_ptr<Chunk> loaded_chunk = storage.load_chunk({3, -4, 5});
+  ASSERT_NE(loaded_chunk, nullptr);
+  expect_same_blocks(current_chunk, *loaded_chunk);
+
+  const auto region_size = std::filesystem::file_size(storage.region_path(region_file::region_position({3, -4, 5})));
+  storage.save_chunk(Chunk(Block(block_type::air), 3, -4, 5));
+  EXPECT_EQ(std::filesystem::file_size(storage.region_path(region_file::region_position({3, -4, 5}))), region_size);
+  loaded_chunk = storage.load_chunk({3, -4, 5});
+  ASSERT_NE(loaded_chunk, nullptr);
+  EXPECT_TRUE(loaded_chunk->is_uniform());
+  EXPECT_EQ(loaded_chunk->get_uniform_block().block_type, block_type::air);
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(region_file, mmap_and_buffered_reads_match) {
+  Generator generator(2510586073u);
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (int32_t x = 0; x < 3; x++) {
+    chunks.push_back(generator.generateChunk(x, -1, 0, true));
+    chunks.push_back(generator.generateChunk(x, 0, 0, true));
+  }
+
+  for (const int compression_level : {0, 1}) {
+    const std::filesystem::path directory = test_directory("read_modes_" + std::to_string(compression_level));
+    region_storage(directory, compression_level).save_chunks(chunks);
+
+    region_storage buffered(directory, compression_level, region_read_mode::buffered);
+    region_storage mapped(directory, compression_level, region_read_mode::mmap);
+    for (const auto &current_chunk : chunks) {
+      std::unique_ptr<Chunk> buffered_chunk = buffered.load_chunk(current_chunk->get_position());
+      std::unique_ptr<Chunk> mapped_chunk = mapped.load_chunk(current_chunk->get_position());
+      ASSERT_NE(buffered_chunk, nullptr);
+      ASSERT_NE(mapped_chunk, nullptr);
+      expect_same_blocks(*current_chunk, *buffered_chunk);
+      expect_same_blocks(*current_chunk, *mapped_chunk);
+    }
+    std::filesystem::remove_all(directory);
+  }
+}
+
+TEST(region_file, view_raw_chunk_in_mapping) {
+  if (!mapped_file::is_supported()) {
+    GTEST_SKIP() << "No memory mapping on this system";
+  }
+  const std::filesystem::path directory = test_directory("view");
+  std::filesystem::create_directories(directory);
+  // Mixed chunks, their payloads shrink when compressed
+  std::vector<Block> blocks(block_count, Block(block_type::air));
+  for (size_t i = 0; i < block_count; i += 5) {
+    blocks[i].block_type = static_cast<block_type::block_t>(1 + i % 3);
+  }
+  auto first_chunk = std::make_unique<Chunk>(blocks, 0, 0, 0);
+  std::reverse(blocks.begin(), blocks.end());
+  auto second_chunk = std::make_unique<Chunk>(blocks, 1, 0, 0);
+
+  region_file region(directory / "r.0.0.0.wocr", region_read_mode::mmap);
+  region.write_chunks({first_chunk.get()}, 0);
+
+  chunk_view view;
+  ASSERT_TRUE(region.view_chunk({0, 0, 0}, view));
+  ASSERT_EQ(view.count, first_chunk->size());
+  for (size_t i = 0; i < view.count; i++) {
+    ASSERT_EQ(view.get(i), first_chunk->get_storage().get(i));
+  }
+  EXPECT_FALSE(region.view_chunk({1, 0, 0}, view));
+
+  // Appended after the file was mapped
+  region.write_chunks({second_chunk.get()}, 0);
+  std::unique_ptr<Chunk> loaded_chunk = region.read_chunk({1, 0, 0});
+  ASSERT_NE(loaded_chunk, nullptr);
+  expect_same_blocks(*second_chunk, *loaded_chunk);
+
+  // Compressed payloads are not viewable, but still readable
+  region.write_chunks({first_chunk.get()}, 6);
+  EXPECT_FALSE(region.view_chunk({0, 0, 0}, view));
+  loaded_chunk = region.read_chunk({0, 0, 0});
+  ASSERT_NE(loaded_chunk, nullptr);
+  expect_same_blocks(*first_chunk, *loaded_chunk);
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(region_file, delta_save_and_load) {
+  const std::filesystem::path directory = test_directory("delta");
+  auto generator = std::make_shared<Generator>(2510586073u);
+  const chunk_baseline_fn baseline = [generator](const benlib::Vector3i &pos) { return generator->generate_baseline_chunk(pos.x, pos.y, pos.z); };
+
+  // A mixed chunk: a few edits, and the same chunk saved in full for comparison
+  std::unique_ptr<Chunk> edited_chunk;
+  for (int32_t y = -4; y < 4 && edited_chunk == nullptr; y++) {
+    std::unique_ptr<Chunk> current_chunk = generator->generate_baseline_chunk(2, y, 3);
+    if (!current_chunk->is_uniform()) {
+      edited_chunk = std::move(current_chunk);
+    }
+  }
+  ASSERT_NE(edited_chunk, nullptr);
+  std::unique_ptr<Chunk> unedited_chunk = generator->generate_baseline_chunk(3, edited_chunk->get_position().y, 3);
+  EXPECT_FALSE(edited_chunk->is_edited());
+  for (int i = 0; i < 20; i++) {
+    edited_chunk->set_block(i, i % 7, 5, Block(block_type::grass));
+  }
+  EXPECT_TRUE(edited_chunk->is_edited());
+
+  region_storage full_storage(directory / "full", 1);
+  full_storage.save_chunk(*edited_chunk);
+
+  region_storage storage(directory / "delta", 1);
+  storage.set_save_mode(region_save_mode::delta, baseline);
+  EXPECT_TRUE(storage.needs_save(*edited_chunk));
+  EXPECT_FALSE(storage.needs_save(*unedited_chunk));
+  storage.save_chunk(*edited_chunk);
+  EXPECT_LT(storage.get_payload_bytes(), full_storage.get_payload_bytes());
+
+  // Regenerated and edited again on load
+  std::unique_ptr<Chunk> loaded_chunk = storage.load_chunk(edited_chunk->get_position());
+  ASSERT_NE(loaded_chunk, nullptr);
+  expect_same_blocks(*edited_chunk, *loaded_chunk);
+  EXPECT_TRUE(loaded_chunk->is_saved());
+  EXPECT_TRUE(loaded_chunk->is_edited());
+  EXPECT_FALSE(storage.needs_save(*loaded_chunk));
+
+  // Delta payloads need the baseline
+  region_storage without_baseline(directory / "delta", 1);
+  EXPECT_TRUE(without_baseline.contains(edited_chunk->get_position()));
+  EXPECT_EQ(without_baseline.load_chunk(edited_chunk->get_position()), nullptr);
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(region_file, structures_are_not_edits) {
+  Generator generator(2510586073u);
+  std::vector<pending_block> blocks = {{0, block_type::wood}, {1, block_type::leaves}};
+  generator.get_decoration_store().set({0, 0, 0}, {0, -1, 0}, blocks);
+
+  Chunk current_chunk(Block(block_type::air), 0, 0, 0);
+  EXPECT_TRUE(generator.apply_pending_decorations(current_chunk));
+  EXPECT_FALSE(current_chunk.is_edited());
+  EXPECT_FALSE(current_chunk.is_saved());
+  EXPECT_EQ(current_chunk.get_block(0, 0, 0).block_type, block_type::wood);
+}
+
+auto main(int argc, char **argv) -> int {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}